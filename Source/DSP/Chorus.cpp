@@ -0,0 +1,342 @@
+#include "Chorus.h"
+
+Chorus::Chorus()
+{
+}
+
+Chorus::~Chorus()
+{
+}
+
+const std::array<Chorus::LFOTable, Chorus::numWaveforms>& Chorus::getLFOTables()
+{
+    // Built once by additive synthesis. Harmonics stop at lfoHarmonics and are
+    // Lanczos-tapered, so the saw and square edges are rounded off instead of
+    // stepping the delay (and clicking) between control spans
+    static const auto tables = []
+    {
+        std::array<LFOTable, numWaveforms> result {};
+    
+        for (int waveformType = 0; waveformType < numWaveforms; ++waveformType)
+        {
+            auto& table = result[static_cast<size_t>(waveformType)];
+    
+            for (int i = 0; i < lfoTableSize; ++i)
+            {
+                const double x = juce::MathConstants<double>::twoPi * i / lfoTableSize;
+                double value = 0.0;
+    
+                for (int k = 1; k <= lfoHarmonics; ++k)
+                {
+                    const double sigma = (k == 1) ? 1.0 : std::sin(juce::MathConstants<double>::pi * k / (lfoHarmonics + 1))
+                                                          / (juce::MathConstants<double>::pi * k / (lfoHarmonics + 1));
+                    const bool odd = (k % 2) == 1;
+    
+                    switch (waveformType)
+                    {
+                        case 0: // sine
+                            value += (k == 1) ? std::sin(x) : 0.0;
+                            break;
+                        case 1: // triangle
+                            if (odd)
+                                value += sigma * (((k / 2) % 2 == 0) ? 1.0 : -1.0) * std::sin(k * x) / (k * k);
+                            break;
+                        case 2: // saw
+                            value += sigma * (odd ? 1.0 : -1.0) * std::sin(k * x) / k;
+                            break;
+                        case 3: // square
+                        default:
+                            if (odd)
+                                value += sigma * std::sin(k * x) / k;
+                            break;
+                    }
+                }
+    
+                table[static_cast<size_t>(i)] = static_cast<float>(value);
+            }
+    
+            // Every waveform spans -1 to 1 so depth means the same sweep for all
+            float peak = 0.0f;
+            for (int i = 0; i < lfoTableSize; ++i)
+                peak = juce::jmax(peak, std::abs(table[static_cast<size_t>(i)]));
+    
+            for (int i = 0; i < lfoTableSize; ++i)
+                table[static_cast<size_t>(i)] /= peak;
+    
+            table[lfoTableSize] = table[0];
+        }
+    
+        return result;
+    }();
+    
+    return tables;
+}
+
+void Chorus::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    juce::ignoreUnused(samplesPerBlock);
+    currentSampleRate = sampleRate;
+    
+    // Touch the tables here so the first audio callback never builds them
+    getLFOTables();
+    
+    maxDelayInSamples = static_cast<int>(std::ceil(maxDelayMs * 0.001 * sampleRate));
+    bufferSize = juce::nextPowerOfTwo(maxDelayInSamples + FractionalDelay::numTaps);
+    bufferMask = bufferSize - 1;
+    writeIndex = 0;
+    
+    const int channels = juce::jmax(1, numChannels);
+    ringBuffer.setSize(channels, bufferSize, false, true, false);
+    ringBuffer.clear();
+    feedbackState.assign(static_cast<size_t>(channels), 0.0f);
+    
+    // Taps must stay behind the span being written (see controlInterval)
+    minimumDelaySamples = juce::jmax(static_cast<float>(controlInterval + FractionalDelay::numTaps),
+                                     static_cast<float>(minimumDelayMs * 0.001 * sampleRate));
+    feedbackDampingCoefficient = static_cast<float>(1.0 - std::exp(-juce::MathConstants<double>::twoPi
+                                                                   * juce::jmin(feedbackCutoffHz, sampleRate * 0.45) / sampleRate));
+    
+    lfoPhase = 0.0;
+    updateLFOs();
+    updateDelayLines();
+    updateVoices();
+    voiceDelay.assign(static_cast<size_t>(channels * maxVoices), baseDelaySamples);
+    
+    isPrepared = true;
+}
+
+void Chorus::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    if (!isPrepared || !enabled)
+        return;
+    
+    const int numChannels = juce::jmin(buffer.getNumChannels(), ringBuffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+    const float lowest = minimumDelaySamples;
+    const float highest = static_cast<float>(maxDelayInSamples);
+    std::array<float, maxVoices> voiceTargets {};
+    int length = 0;
+    
+    for (int offset = 0; offset < numSamples; offset += length)
+    {
+        length = juce::jmin(controlInterval, numSamples - offset);
+    
+        // The LFO is read once per span, at the span's end
+        lfoPhase += lfoIncrement * length;
+        lfoPhase -= std::floor(lfoPhase);
+    
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float channelPhase = static_cast<float>(lfoPhase) + (channel == 1 ? phaseOffset : 0.0f);
+    
+            for (int voice = 0; voice < numVoices; ++voice)
+            {
+                float phase = channelPhase + voicePhase[static_cast<size_t>(voice)];
+                phase -= std::floor(phase);
+    
+                const float base = baseDelaySamples * voiceDelayScale[static_cast<size_t>(voice)];
+                const float target = base + sweepSamples * generateLFOSample(phase, waveform);
+                voiceTargets[static_cast<size_t>(voice)] = juce::jlimit(lowest, highest, target);
+            }
+    
+            processSpan(channel, buffer.getWritePointer(channel, offset), length, voiceTargets.data());
+        }
+    
+        writeIndex = (writeIndex + length) & bufferMask;
+    }
+}
+
+void Chorus::gatherVoice(const float* ring, float& previousDelay, float targetDelay, int numSamples)
+{
+    const float start = previousDelay;
+    const float step = (targetDelay - start) / static_cast<float>(numSamples);
+    const int mask = bufferMask;
+    previousDelay = targetDelay;
+    
+    int i = 0;
+    
+    while (i < numSamples)
+    {
+        // While the whole part of the delay holds still, each output reads one
+        // sample further along the ring, so the run's taps are contiguous and
+        // the loop below needs no gather. Chorus sweeps cross a whole sample
+        // at most once or twice per span
+        const int whole = static_cast<int>(start + step * static_cast<float>(i + 1));
+        int end = i + 1;
+    
+        while (end < numSamples && static_cast<int>(start + step * static_cast<float>(end + 1)) == whole)
+            ++end;
+    
+        // Reading 'fraction' before sample (write - whole) is reading at
+        // (write - whole - 1) + (1 - fraction); the first tap is one before that
+        const int first = (writeIndex + i - whole - 2) & mask;
+    
+        if (first + (end - i) + FractionalDelay::numTaps <= bufferSize)
+        {
+            const float* taps = ring + first - i;
+    
+            for (int k = i; k < end; ++k)
+            {
+                const float fraction = start + step * static_cast<float>(k + 1) - static_cast<float>(whole);
+                const auto w = FractionalDelay::computeWeights(FractionalDelay::Quality::Cubic, 1.0f - fraction);
+    
+                spanWet[static_cast<size_t>(k)] += w[0] * taps[k] + w[1] * taps[k + 1]
+                                                 + w[2] * taps[k + 2] + w[3] * taps[k + 3];
+            }
+        }
+        else
+        {
+            // The run straddles the end of the ring
+            for (int k = i; k < end; ++k)
+            {
+                const float fraction = start + step * static_cast<float>(k + 1) - static_cast<float>(whole);
+                const auto w = FractionalDelay::computeWeights(FractionalDelay::Quality::Cubic, 1.0f - fraction);
+                const int tap = first + (k - i);
+    
+                spanWet[static_cast<size_t>(k)] += w[0] * ring[tap & mask] + w[1] * ring[(tap + 1) & mask]
+                                                 + w[2] * ring[(tap + 2) & mask] + w[3] * ring[(tap + 3) & mask];
+            }
+        }
+    
+        i = end;
+    }
+}
+
+void Chorus::processSpan(int channel, float* io, int numSamples, const float* voiceTargets)
+{
+    auto* ring = ringBuffer.getWritePointer(channel);
+    auto* previousDelays = voiceDelay.data() + channel * maxVoices;
+    
+    std::fill(spanWet.begin(), spanWet.begin() + numSamples, 0.0f);
+    
+    for (int voice = 0; voice < numVoices; ++voice)
+        gatherVoice(ring, previousDelays[voice], voiceTargets[voice], numSamples);
+    
+    // One ring write, feedback path and dry/wet mix for however many voices
+    const int mask = bufferMask;
+    const float feedbackGain = feedback * voiceFeedbackGain;
+    const float wetGain = voiceWetGain;
+    const float wetAmount = mix;
+    const float damping = feedbackDampingCoefficient;
+    float filtered = feedbackState[static_cast<size_t>(channel)];
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float delayed = spanWet[static_cast<size_t>(i)];
+    
+        // Negative feedback flips the comb, putting notches at the multiples
+        // of the delay frequency for the hollow through-zero flanger sound
+        const float input = io[i];
+        filtered += damping * (delayed - filtered);
+        ring[(writeIndex + i) & mask] = input + feedbackGain * filtered;
+        io[i] = input + wetAmount * (wetGain * delayed - input);
+    }
+    
+    feedbackState[static_cast<size_t>(channel)] = filtered;
+}
+
+float Chorus::generateLFOSample(float phase, int waveformType) const
+{
+    const auto& table = getLFOTables()[static_cast<size_t>(juce::jlimit(0, numWaveforms - 1, waveformType))];
+    
+    const float position = phase * static_cast<float>(lfoTableSize);
+    const int index = juce::jlimit(0, lfoTableSize - 1, static_cast<int>(position));
+    const float fraction = position - static_cast<float>(index);
+    
+    return table[static_cast<size_t>(index)] + fraction * (table[static_cast<size_t>(index + 1)] - table[static_cast<size_t>(index)]);
+}
+
+void Chorus::releaseResources()
+{
+    ringBuffer.setSize(0, 0);
+    voiceDelay.clear();
+    feedbackState.clear();
+    isPrepared = false;
+}
+
+void Chorus::setRate(float rateHz)
+{
+    rate = juce::jlimit(0.05f, 5.0f, rateHz);
+    updateLFOs();
+}
+
+void Chorus::setDepth(float newDepth)
+{
+    depth = juce::jlimit(0.0f, 1.0f, newDepth);
+    updateDelayLines();
+}
+
+void Chorus::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void Chorus::setFeedback(float newFeedback)
+{
+    feedback = juce::jlimit(-0.95f, 0.95f, newFeedback);
+}
+
+void Chorus::setDelay(float delayMs)
+{
+    baseDelayMs = juce::jlimit(1.0f, 50.0f, delayMs);
+    updateDelayLines();
+}
+
+void Chorus::setSpread(float newSpread)
+{
+    spread = juce::jlimit(0.0f, 1.0f, newSpread);
+    updateLFOs();
+}
+
+void Chorus::setWaveform(int newWaveform)
+{
+    waveform = juce::jlimit(0, numWaveforms - 1, newWaveform);
+}
+
+void Chorus::setVoices(int voices)
+{
+    numVoices = (voices <= 1) ? 1 : juce::jlimit(3, maxVoices, voices);
+    updateVoices();
+}
+
+void Chorus::applyParameters(const ChorusParams& params)
+{
+    setEnabled(params.enabled);
+    setRate(params.rateHz);
+    setDepth(params.depth);
+    setMix(params.mix);
+    setVoices(params.voices);
+}
+
+void Chorus::updateLFOs()
+{
+    lfoIncrement = rate / currentSampleRate;
+    
+    // Full spread puts the right channel's LFO half a cycle behind the left
+    phaseOffset = 0.5f * spread;
+}
+
+void Chorus::updateDelayLines()
+{
+    // The sweep scales with the base delay so depth feels the same for a short
+    // flanger and a long chorus, and never pushes the tap through zero
+    baseDelaySamples = static_cast<float>(baseDelayMs * 0.001 * currentSampleRate);
+    sweepSamples = 0.9f * depth * baseDelaySamples;
+}
+
+void Chorus::updateVoices()
+{
+    // Voices sit evenly round the LFO cycle with base delays spread over +-15%,
+    // so no two of them line up in pitch or time
+    for (int voice = 0; voice < maxVoices; ++voice)
+    {
+        const float position = (numVoices > 1) ? static_cast<float>(voice) / static_cast<float>(numVoices - 1) : 0.5f;
+        voicePhase[static_cast<size_t>(voice)] = static_cast<float>(voice) / static_cast<float>(numVoices);
+        voiceDelayScale[static_cast<size_t>(voice)] = 1.0f + 0.3f * (position - 0.5f);
+    }
+    
+    // Roughly equal loudness for any count of decorrelated voices, and a
+    // feedback sum that can never exceed a single voice
+    voiceWetGain = 1.0f / std::sqrt(static_cast<float>(numVoices));
+    voiceFeedbackGain = 1.0f / static_cast<float>(numVoices);
+}
@@ -1,11 +1,19 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
 #include "../Preset/PresetSchema.h"
+#include "FractionalDelay.h"
+#include <array>
+#include <vector>
 
 /**
  * Chorus/Flanger modulation effect
- * Capable of traditional chorus, flanger, and abstract modulation sounds
+ * Capable of traditional chorus, flanger, and abstract modulation sounds.
+ * The LFO reads band-limited wavetables and is evaluated once per control
+ * span; the delay in between moves linearly, so a span's taps read runs of
+ * contiguous ring samples with weights worked out inline.
+ * Ensemble mode runs up to eight voices as extra taps on the same ring, so
+ * the ring write, feedback and mix are paid once whatever the voice count
  */
 class Chorus
 {
@@ -31,6 +39,7 @@ public:
     void setDelay(float delayMs);       // 1 to 50 ms (base delay time)
     void setSpread(float spread);       // 0 to 1 (stereo width)
     void setWaveform(int waveform);     // 0=sine, 1=triangle, 2=saw, 3=square
+    void setVoices(int voices);         // 1 (classic) or 3 to 8 (ensemble)
     
     // Apply parameters from preset
     void applyParameters(const ChorusParams& params);
@@ -45,28 +54,69 @@ private:
     float baseDelayMs = 7.0f;
     float spread = 0.7f;
     int waveform = 0; // sine
+    int numVoices = 1;
     
-    // DSP components
-    juce::dsp::DelayLine<float> delayLineL, delayLineR;
-    juce::dsp::Oscillator<float> lfoL, lfoR;
+    // LFO wavetables: one band-limited cycle per waveform, shared by every instance.
+    // The extra point at the end repeats the first so lookups never wrap
+    static constexpr int numWaveforms = 4;
+    static constexpr int lfoTableSize = 2048;
+    static constexpr int lfoHarmonics = 24;
+    using LFOTable = std::array<float, lfoTableSize + 1>;
+    static const std::array<LFOTable, numWaveforms>& getLFOTables();
     
-    // Filtering for feedback
-    juce::dsp::IIR::Filter<float> feedbackFilterL, feedbackFilterR;
+    // Delay storage: one power-of-two ring per channel sharing a write position
+    juce::AudioBuffer<float> ringBuffer;
+    int bufferSize = 0;
+    int bufferMask = 0;
+    int writeIndex = 0;
+    static constexpr float maxDelayMs = 100.0f;         // 50 ms base plus the widest sweep
+    static constexpr float minimumDelayMs = 0.5f;
+    
+    // Control rate: the LFO is read at the end of each span of this many samples.
+    // Every tap of a span is gathered before the span is written, so the
+    // shortest delay has to reach back past the span's start
+    static constexpr int controlInterval = 32;
+    double lfoPhase = 0.0;          // cycles, 0 to 1
+    double lfoIncrement = 0.0;      // cycles per sample
+    float baseDelaySamples = 0.0f;
+    float sweepSamples = 0.0f;
+    float minimumDelaySamples = 4.0f;
+    
+    // Ensemble voices: LFO phases spread evenly round the cycle, base delays
+    // staggered around baseDelaySamples. Classic mode is the single voice 0
+    static constexpr int maxVoices = 8;
+    std::array<float, maxVoices> voicePhase {};
+    std::array<float, maxVoices> voiceDelayScale {};
+    float voiceWetGain = 1.0f;
+    float voiceFeedbackGain = 1.0f;
+    std::vector<float> voiceDelay;      // per channel and voice: delay reached at the end of the last span
+    
+    // Sum of every voice's taps over one span
+    std::array<float, controlInterval> spanWet {};
+    
+    // Gentle lowpass in the feedback path keeps strong flanging from ringing harshly
+    static constexpr double feedbackCutoffHz = 9000.0;
+    float feedbackDampingCoefficient = 1.0f;
+    std::vector<float> feedbackState;
     
     // Processing state
     double currentSampleRate = 44100.0;
     int maxDelayInSamples = 0;
     bool isPrepared = false;
     
-    // LFO phase offset for stereo spread
+    // LFO phase offset for stereo spread (cycles, applied to the right channel)
     float phaseOffset = 0.0f;
     
     // Waveform generation
-    float generateLFOSample(float phase, int waveformType);
+    float generateLFOSample(float phase, int waveformType) const;
+    
+    void gatherVoice(const float* ring, float& previousDelay, float targetDelay, int numSamples);
+    void processSpan(int channel, float* io, int numSamples, const float* voiceTargets);
     
     // Parameter updates
     void updateLFOs();
     void updateDelayLines();
+    void updateVoices();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Chorus)
 };
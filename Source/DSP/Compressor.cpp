@@ -0,0 +1,285 @@
+#include "Compressor.h"
+#include "../Utils/FastMath.h"
+
+Compressor::Compressor()
+{
+}
+
+Compressor::~Compressor()
+{
+}
+
+void Compressor::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    
+    // Scratch for the detector and gain passes, allocated once here
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    levelScratch.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    gainScratch.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    
+    // Lookahead ring long enough for the longest setting
+    const int ringSize = juce::nextPowerOfTwo(static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * sampleRate)) + 1);
+    lookaheadBuffer.setSize(juce::jmax(1, numChannels), ringSize, false, true, false);
+    lookaheadBuffer.clear();
+    lookaheadMask = ringSize - 1;
+    lookaheadWriteIndex = 0;
+    
+    envelopeDb = 0.0f;
+    
+    updateGainComputer();
+    updateEnvelopeFollower();
+    updateLookahead();
+    
+    isPrepared = true;
+}
+
+void Compressor::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    processBlock(buffer, nullptr);
+}
+
+void Compressor::processBlock(juce::AudioBuffer<float>& buffer, SidechainKey* key)
+{
+    if (!isPrepared || !enabled)
+        return;
+    
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), lookaheadBuffer.getNumChannels());
+    
+    if (numChannels == 0 || numSamples == 0)
+        return;
+    
+    float inputRMS = 0.0f;
+    for (int channel = 0; channel < numChannels; ++channel)
+        inputRMS = juce::jmax(inputRMS, calculateRMS(buffer.getReadPointer(channel), numSamples));
+    
+    // The shared key is analysed by whichever stage asks first this block
+    const bool keyed = sidechainEnabled && key != nullptr && key->isActive();
+    const float* keyLevelsDb = keyed ? key->getLevelsDb() : nullptr;
+    const int keyedSamples = keyed ? key->getNumSamples() : 0;
+    
+    // Hosts may send more than they announced; run those in prepared-size chunks
+    float deepestGainDb = 0.0f;
+    
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+    {
+        const int length = juce::jmin(maxBlockSize, numSamples - offset);
+        processChunk(buffer, offset, length, (offset + length <= keyedSamples) ? keyLevelsDb + offset : nullptr);
+        deepestGainDb = juce::jmin(deepestGainDb, envelopeDb);
+    }
+    
+    float outputRMS = 0.0f;
+    for (int channel = 0; channel < numChannels; ++channel)
+        outputRMS = juce::jmax(outputRMS, calculateRMS(buffer.getReadPointer(channel), numSamples));
+    
+    inputLevel.store(inputRMS);
+    outputLevel.store(outputRMS);
+    currentGainReduction.store(-deepestGainDb);
+}
+
+void Compressor::processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples, const float* keyLevelsDb)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), lookaheadBuffer.getNumChannels());
+    float* levels = levelScratch.data();
+    float* gains = gainScratch.data();
+    
+    if (keyLevelsDb != nullptr)
+    {
+        // External key: its levels are already in dB, straight into the curve
+        gainComputer.process(keyLevelsDb, levels, numSamples);
+    }
+    else
+    {
+        detectLevels(buffer, offset, numSamples, numChannels);
+        gainComputer.process(levels, levels, numSamples);
+    }
+    
+    // Attack/release smoothing of the gain change. The coefficient is picked
+    // with a select rather than a branch, so the loop has no jumps to mispredict
+    // as the signal crosses the threshold
+    const float attack = attackCoefficient;
+    const float release = releaseCoefficient;
+    float envelope = envelopeDb;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float target = levels[i];
+        const float coefficient = (target < envelope) ? attack : release;
+        envelope = target + coefficient * (envelope - target);
+        gains[i] = envelope;
+    }
+    
+    envelopeDb = envelope;
+    
+    // Back to linear with makeup and the parallel mix folded into one factor:
+    // dry * (1 - mix) + dry * gain * makeup * mix
+    FastMath::decibelsToGain(gains, gains, numSamples);
+    
+    const float wetScale = mix * juce::Decibels::decibelsToGain(makeupDb);
+    const float dryScale = 1.0f - mix;
+    
+    for (int i = 0; i < numSamples; ++i)
+        gains[i] = dryScale + wetScale * gains[i];
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        applyDelayedGain(buffer.getWritePointer(channel, offset), lookaheadBuffer.getWritePointer(channel), gains, numSamples);
+    
+    lookaheadWriteIndex = (lookaheadWriteIndex + numSamples) & lookaheadMask;
+}
+
+void Compressor::detectLevels(const juce::AudioBuffer<float>& buffer, int offset, int numSamples, int numChannels)
+{
+    float* levels = levelScratch.data();
+    
+    // Stereo-linked peak detector: the largest magnitude across channels
+    const float* first = buffer.getReadPointer(0, offset);
+    for (int i = 0; i < numSamples; ++i)
+        levels[i] = std::abs(first[i]);
+    
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        const float* input = buffer.getReadPointer(channel, offset);
+        for (int i = 0; i < numSamples; ++i)
+            levels[i] = juce::jmax(levels[i], std::abs(input[i]));
+    }
+    
+    // Level to dB, flat and vectorized like the curve that follows
+    FastMath::gainToDecibels(levels, levels, numSamples);
+}
+
+void Compressor::applyDelayedGain(float* io, float* ring, const float* gains, int numSamples) const
+{
+    if (lookaheadSamples == 0)
+    {
+        juce::FloatVectorOperations::multiply(io, gains, numSamples);
+        return;
+    }
+    
+    // The audio runs lookaheadSamples behind the detector. Spans stop where
+    // either index wraps and are never longer than the delay, so each one
+    // reads only samples written before it
+    const int ringSize = lookaheadMask + 1;
+    int done = 0;
+    
+    while (done < numSamples)
+    {
+        const int writeIndex = (lookaheadWriteIndex + done) & lookaheadMask;
+        const int readIndex = (writeIndex - lookaheadSamples) & lookaheadMask;
+        const int length = juce::jmin(juce::jmin(numSamples - done, lookaheadSamples),
+                                      juce::jmin(ringSize - writeIndex, ringSize - readIndex));
+    
+        float* block = io + done;
+        const float* blockGains = gains + done;
+        const float* read = ring + readIndex;
+        float* write = ring + writeIndex;
+    
+        for (int i = 0; i < length; ++i)
+        {
+            const float input = block[i];
+            block[i] = read[i] * blockGains[i];
+            write[i] = input;
+        }
+    
+        done += length;
+    }
+}
+
+void Compressor::releaseResources()
+{
+    levelScratch.clear();
+    gainScratch.clear();
+    lookaheadBuffer.setSize(0, 0);
+    isPrepared = false;
+}
+
+void Compressor::setRatio(float newRatio)
+{
+    ratio = juce::jlimit(1.0f, 10.0f, newRatio);
+    updateGainComputer();
+}
+
+void Compressor::setThreshold(float newThresholdDb)
+{
+    thresholdDb = juce::jlimit(-60.0f, 0.0f, newThresholdDb);
+    updateGainComputer();
+}
+
+void Compressor::setAttack(float newAttackMs)
+{
+    attackMs = juce::jlimit(0.1f, 50.0f, newAttackMs);
+    updateEnvelopeFollower();
+}
+
+void Compressor::setRelease(float newReleaseMs)
+{
+    releaseMs = juce::jlimit(10.0f, 500.0f, newReleaseMs);
+    updateEnvelopeFollower();
+}
+
+void Compressor::setMakeupGain(float newMakeupDb)
+{
+    makeupDb = juce::jlimit(-12.0f, 12.0f, newMakeupDb);
+}
+
+void Compressor::setKnee(float newKnee)
+{
+    knee = juce::jlimit(0.0f, 1.0f, newKnee);
+    updateGainComputer();
+}
+
+void Compressor::setLookahead(float newLookaheadMs)
+{
+    lookaheadMs = juce::jlimit(0.0f, maxLookaheadMs, newLookaheadMs);
+    updateLookahead();
+}
+
+void Compressor::setSidechain(bool shouldUseSidechain)
+{
+    sidechainEnabled = shouldUseSidechain;
+}
+
+void Compressor::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void Compressor::applyParameters(const CompressorParams& params)
+{
+    setEnabled(params.enabled);
+    setRatio(params.ratio);
+    setThreshold(params.thresholdDb);
+    setAttack(params.attackMs);
+    setRelease(params.releaseMs);
+    setMakeupGain(params.makeupDb);
+}
+
+float Compressor::calculateRMS(const float* samples, int numSamples)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < numSamples; ++i)
+        sum += samples[i] * samples[i];
+    
+    return std::sqrt(sum / static_cast<float>(juce::jmax(1, numSamples)));
+}
+
+void Compressor::updateEnvelopeFollower()
+{
+    // One-pole coefficients reaching 1 - 1/e of a step in the given time
+    attackCoefficient = static_cast<float>(std::exp(-1.0 / (attackMs * 0.001 * currentSampleRate)));
+    releaseCoefficient = static_cast<float>(std::exp(-1.0 / (releaseMs * 0.001 * currentSampleRate)));
+}
+
+void Compressor::updateLookahead()
+{
+    // Clamped to the ring, which prepareToPlay sized for maxLookaheadMs
+    const int requested = static_cast<int>(std::round(lookaheadMs * 0.001 * currentSampleRate));
+    lookaheadSamples = juce::jlimit(0, juce::jmax(0, lookaheadMask), requested);
+}
+
+void Compressor::updateGainComputer()
+{
+    gainComputer.thresholdDb = thresholdDb;
+    gainComputer.ratio = ratio;
+    gainComputer.kneeDb = knee * 24.0f;     // soft knee up to 24 dB wide
+}
@@ -1,11 +1,18 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
 #include "../Preset/PresetSchema.h"
+#include "GainComputer.h"
+#include "SidechainKey.h"
+#include <vector>
 
 /**
  * Dynamic range compressor
- * Supports traditional compression and creative pumping effects
+ * Supports traditional compression and creative pumping effects.
+ * Each block runs as a series of flat passes over preallocated scratch:
+ * stereo-linked peak detection, dB conversion and the soft-knee gain
+ * computer all vectorize; only the attack/release smoother is recursive.
+ * Lookahead delay, gain, makeup and parallel mix are then applied together
  */
 class Compressor
 {
@@ -18,6 +25,9 @@ public:
     void processBlock(juce::AudioBuffer<float>& buffer);
     void releaseResources();
     
+    // With the sidechain enabled and a key given, the detector follows the key
+    void processBlock(juce::AudioBuffer<float>& buffer, SidechainKey* key);
+    
     // Parameter control
     void setEnabled(bool enabled) { this->enabled = enabled; }
     bool isEnabled() const { return enabled; }
@@ -55,18 +65,23 @@ private:
     bool sidechainEnabled = false;
     float mix = 1.0f;
     
-    // DSP components
-    juce::dsp::Gain<float> inputGain, outputGain, makeupGain;
-    juce::dsp::DelayLine<float> lookaheadDelayL, lookaheadDelayR;
+    // Gain computation and smoothing, both in the log domain
+    GainComputer gainComputer;
+    float attackCoefficient = 0.0f;
+    float releaseCoefficient = 0.0f;
+    float envelopeDb = 0.0f;                // smoothed gain change, zero or negative
     
-    // Envelope followers
-    juce::SmoothedValue<float> envelopeFollower;
-    juce::SmoothedValue<float> gainSmoother;
+    // Per-block scratch, sized in prepareToPlay; longer blocks are split
+    std::vector<float> levelScratch;
+    std::vector<float> gainScratch;
+    int maxBlockSize = 0;
     
-    // Peak detection
-    float peakHoldL = 0.0f;
-    float peakHoldR = 0.0f;
-    int peakHoldCounter = 0;
+    // Lookahead: one preallocated power-of-two ring per channel
+    static constexpr float maxLookaheadMs = 10.0f;
+    juce::AudioBuffer<float> lookaheadBuffer;
+    int lookaheadMask = 0;
+    int lookaheadWriteIndex = 0;
+    int lookaheadSamples = 0;
     
     // Processing state
     double currentSampleRate = 44100.0;
@@ -77,17 +92,18 @@ private:
     std::atomic<float> inputLevel{0.0f};
     std::atomic<float> outputLevel{0.0f};
     
-    // Compression calculation
-    float calculateGainReduction(float inputLevel);
-    float applyKnee(float inputLevel, float threshold, float knee);
+    // Block processing
+    void processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples, const float* keyLevelsDb);
+    void detectLevels(const juce::AudioBuffer<float>& buffer, int offset, int numSamples, int numChannels);
+    void applyDelayedGain(float* io, float* ring, const float* gains, int numSamples) const;
     
-    // RMS/Peak detection
+    // RMS level for metering
     float calculateRMS(const float* samples, int numSamples);
-    float calculatePeak(const float* samples, int numSamples);
     
     // Parameter updates
     void updateEnvelopeFollower();
     void updateLookahead();
+    void updateGainComputer();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Compressor)
 };
@@ -0,0 +1,498 @@
+#include "ConvolutionReverb.h"
+
+ConvolutionReverb::ConvolutionReverb()
+    : juce::Thread("ConvolutionReverbTail")
+{
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    stopThread(2000);
+}
+
+void ConvolutionReverb::prepare(double sampleRate, int maximumBlockSize)
+{
+    // The worker owns the spectra and response; it must be idle while they are rebuilt
+    stopThread(2000);
+
+    currentSampleRate = sampleRate;
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(juce::jmax(1, maximumBlockSize));
+    spec.numChannels = 2;
+    head.prepare(spec);
+
+    // The head covers a whole block and a partition beyond it, so the input a
+    // tail partition needs has always arrived before the block that plays it
+    headPartitions = juce::jmax(minHeadPartitions, 1 + (static_cast<int>(spec.maximumBlockSize) + partitionSize - 2) / partitionSize);
+    headLength = headPartitions * partitionSize;
+    ringBlocks = juce::nextPowerOfTwo(2 * headPartitions + 4);
+    ringMask = ringBlocks * partitionSize - 1;
+
+    const double tailSamples = maxResponseSeconds * sampleRate - headLength;
+    maxPartitions = juce::jmax(1, static_cast<int>(std::ceil(tailSamples / partitionSize)));
+
+    for (size_t channel = 0; channel < 2; ++channel)
+    {
+        inputRing[channel].assign(static_cast<size_t>(ringMask + 1), 0.0f);
+        outputRing[channel].assign(static_cast<size_t>(ringMask + 1), 0.0f);
+        inputSpectra[channel].assign(static_cast<size_t>(maxPartitions * numBins), Spectrum());
+    }
+
+    fftBuffer.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+    accumulator.assign(static_cast<size_t>(numBins), Spectrum());
+    spectrumIndex = 0;
+    historyStart = 0;
+
+    samplePosition = 0;
+    tailValidFrom = 0;
+    tailBlockReady = false;
+    inputBlockWritable = true;
+    blocksWritten.store(0);
+    blocksProcessed.store(0);
+    restartBlock.store(0);
+    responseRequests.store(0);
+    responsesBuilt.store(0);
+    buildingRequest = 0;
+
+    activeResponse.reset();
+    buildingResponse.reset();
+    responseSeconds.store(0.0f);
+
+    isPrepared = true;
+
+    // Rebuild whichever response was in use at the new rate
+    if (usingLoadedResponse.load())
+    {
+        queueLoadedResponse();
+    }
+    else
+    {
+        synthesisRequested.store(true);
+        requestResponse();
+    }
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void ConvolutionReverb::release()
+{
+    stopThread(2000);
+    head.reset();
+    isPrepared = false;
+}
+
+void ConvolutionReverb::process(float* left, float* right, int numSamples)
+{
+    if (!isPrepared)
+        return;
+
+    const int numChannels = (right != nullptr) ? 2 : 1;
+    int processed = 0;
+
+    while (processed < numSamples)
+    {
+        const int offset = static_cast<int>(samplePosition & (partitionSize - 1));
+
+        if (offset == 0)
+        {
+            const juce::int64 block = samplePosition / partitionSize;
+
+            if (nonRealtime.load(std::memory_order_relaxed))
+                waitForWorker(block);
+
+            const juce::int64 processed = blocksProcessed.load(std::memory_order_acquire);
+
+            // The worker may still be reading this block's slot from the last lap of
+            // the ring; rather than overwrite it, skip this input and restart the tail
+            inputBlockWritable = block - processed < ringBlocks - 1;
+
+            if (!inputBlockWritable)
+            {
+                restartBlock.store(block + 1, std::memory_order_relaxed);
+                tailValidFrom = block + 1 + headPartitions;
+            }
+
+            // Tail block j is computed from input block j - headPartitions; if the
+            // worker missed that deadline, or lost that input, the block goes out head-only
+            tailBlockReady = block >= tailValidFrom && processed > block - headPartitions;
+        }
+
+        // Chunks never cross a partition boundary, so ring accesses stay contiguous
+        const int length = juce::jmin(partitionSize - offset, numSamples - processed);
+        const int ringIndex = static_cast<int>(samplePosition & ringMask);
+        float* chunk[2] = { left + processed, (right != nullptr) ? right + processed : nullptr };
+
+        if (inputBlockWritable)
+        {
+            juce::FloatVectorOperations::copy(inputRing[0].data() + ringIndex, chunk[0], length);
+            juce::FloatVectorOperations::copy(inputRing[1].data() + ringIndex, chunk[numChannels - 1], length);
+        }
+
+        juce::dsp::AudioBlock<float> block(chunk, static_cast<size_t>(numChannels), static_cast<size_t>(length));
+        head.process(juce::dsp::ProcessContextReplacing<float>(block));
+
+        if (tailBlockReady)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::add(chunk[channel], outputRing[static_cast<size_t>(channel)].data() + ringIndex, length);
+        }
+
+        samplePosition += length;
+        processed += length;
+
+        if ((samplePosition & (partitionSize - 1)) == 0)
+        {
+            blocksWritten.store(samplePosition / partitionSize, std::memory_order_release);
+            notify();
+        }
+    }
+}
+
+void ConvolutionReverb::setSyntheticResponse(float rt60Seconds, float highFrequencyRatio)
+{
+    rt60Seconds = juce::jlimit(0.2f, maxResponseSeconds, rt60Seconds);
+    highFrequencyRatio = juce::jlimit(0.05f, 1.0f, highFrequencyRatio);
+
+    if (rt60Seconds == synthesisRt60.load() && highFrequencyRatio == synthesisHighFrequencyRatio.load()
+        && responseSeconds.load() > 0.0f)
+        return;
+
+    synthesisRt60.store(rt60Seconds);
+    synthesisHighFrequencyRatio.store(highFrequencyRatio);
+    synthesisRequested.store(true);
+    requestResponse();
+}
+
+void ConvolutionReverb::loadImpulseResponse(juce::AudioBuffer<float>&& impulse, double impulseSampleRate)
+{
+    if (impulse.getNumChannels() == 0 || impulse.getNumSamples() == 0 || impulseSampleRate <= 0.0)
+        return;
+
+    loadedImpulse = std::make_unique<juce::AudioBuffer<float>>(std::move(impulse));
+    loadedSampleRate = impulseSampleRate;
+    usingLoadedResponse.store(true);
+
+    if (isPrepared)
+        queueLoadedResponse();
+}
+
+void ConvolutionReverb::clearImpulseResponse()
+{
+    loadedImpulse.reset();
+    usingLoadedResponse.store(false);
+    synthesisRequested.store(true);
+    requestResponse();
+}
+
+void ConvolutionReverb::queueLoadedResponse()
+{
+    if (loadedImpulse == nullptr)
+        return;
+
+    // Linear resampling to the processing rate, mono files feed both channels
+    const double ratio = loadedSampleRate / currentSampleRate;
+    const int sourceLength = loadedImpulse->getNumSamples();
+    const int maxLength = static_cast<int>(maxResponseSeconds * currentSampleRate);
+    const int length = juce::jlimit(1, maxLength, static_cast<int>(sourceLength / ratio));
+
+    auto impulse = std::make_unique<juce::AudioBuffer<float>>(2, length);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        const auto* source = loadedImpulse->getReadPointer(juce::jmin(channel, loadedImpulse->getNumChannels() - 1));
+        auto* destination = impulse->getWritePointer(channel);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const double position = i * ratio;
+            const int index = static_cast<int>(position);
+            const float fraction = static_cast<float>(position - index);
+            const float a = source[index];
+            const float b = (index + 1 < sourceLength) ? source[index + 1] : 0.0f;
+            destination[i] = a + fraction * (b - a);
+        }
+    }
+
+    // Swap under the lock, free the superseded request outside it
+    {
+        const juce::SpinLock::ScopedLockType lock(pendingLock);
+        std::swap(pendingImpulse, impulse);
+    }
+
+    requestResponse();
+}
+
+void ConvolutionReverb::requestResponse()
+{
+    // Counted after the request itself is in place, so a worker that sees the
+    // count also sees what was asked for
+    responseRequests.fetch_add(1, std::memory_order_release);
+    notify();
+}
+
+void ConvolutionReverb::waitForWorker(juce::int64 block)
+{
+    // Offline there is no deadline: wait for the tail block and for any
+    // response still being built, so the render never depends on timing
+    auto isReady = [this, block]
+    {
+        return blocksProcessed.load(std::memory_order_acquire) > block - headPartitions
+            && responsesBuilt.load(std::memory_order_acquire) >= responseRequests.load(std::memory_order_acquire);
+    };
+
+    while (!isReady() && isThreadRunning())
+    {
+        notify();
+        workerProgress.wait(10);
+    }
+}
+
+void ConvolutionReverb::run()
+{
+    juce::int64 processed = 0;
+
+    while (!threadShouldExit())
+    {
+        const juce::int64 written = blocksWritten.load(std::memory_order_acquire);
+        const juce::int64 restart = restartBlock.load(std::memory_order_relaxed);
+
+        // Fell so far behind that the audio thread skipped input: drop the backlog
+        // and start the tail again from the first block after the gap. The audio
+        // thread holds back the output until that restarted tail is due
+        if (processed < restart)
+        {
+            for (auto& spectra : inputSpectra)
+                std::fill(spectra.begin(), spectra.end(), Spectrum());
+
+            processed = restart;
+            historyStart = restart;
+            blocksProcessed.store(processed, std::memory_order_release);
+        }
+
+        // Tail blocks always come first; responses are built in the gaps between them
+        if (written > processed)
+        {
+            processTailBlock(processed);
+            blocksProcessed.store(++processed, std::memory_order_release);
+            workerProgress.signal();
+            continue;
+        }
+
+        if (continueBuildingResponse())
+            continue;
+
+        wait(20);
+    }
+}
+
+void ConvolutionReverb::processTailBlock(juce::int64 block)
+{
+    const int ringIndex = static_cast<int>((block * partitionSize) & ringMask);
+    const int previousIndex = (ringIndex - partitionSize) & ringMask;
+    const int outputIndex = static_cast<int>(((block + headPartitions) * partitionSize) & ringMask);
+
+    spectrumIndex = (spectrumIndex + 1) % maxPartitions;
+
+    const auto* response = activeResponse.get();
+    const int numPartitions = (response != nullptr) ? response->numPartitions : 0;
+    auto* bins = reinterpret_cast<Spectrum*>(fftBuffer.data());
+
+    for (size_t channel = 0; channel < 2; ++channel)
+    {
+        // Overlap-save window: the previous partition followed by the new one,
+        // or silence before it when the tail has just restarted
+        if (block > historyStart)
+            std::copy_n(inputRing[channel].data() + previousIndex, partitionSize, fftBuffer.data());
+        else
+            std::fill_n(fftBuffer.data(), partitionSize, 0.0f);
+
+        std::copy_n(inputRing[channel].data() + ringIndex, partitionSize, fftBuffer.data() + partitionSize);
+        std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+        auto* spectra = inputSpectra[channel].data();
+        std::copy_n(bins, numBins, spectra + spectrumIndex * numBins);
+
+        if (numPartitions == 0)
+        {
+            std::fill_n(outputRing[channel].data() + outputIndex, partitionSize, 0.0f);
+            continue;
+        }
+
+        // Frequency-domain delay line: partition p of the IR meets the input from p blocks ago
+        std::fill(accumulator.begin(), accumulator.end(), Spectrum());
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            int slot = spectrumIndex - p;
+            if (slot < 0)
+                slot += maxPartitions;
+
+            const auto* x = spectra + slot * numBins;
+            const auto* h = response->partitions[channel].data() + p * numBins;
+
+            // Written out rather than using complex operator*, which adds NaN/inf recovery
+            for (int b = 0; b < numBins; ++b)
+            {
+                const float re = x[b].real() * h[b].real() - x[b].imag() * h[b].imag();
+                const float im = x[b].real() * h[b].imag() + x[b].imag() * h[b].real();
+                accumulator[static_cast<size_t>(b)] += Spectrum(re, im);
+            }
+        }
+
+        // The inverse transform expects the full, conjugate-symmetric spectrum
+        std::copy(accumulator.begin(), accumulator.end(), bins);
+
+        for (int b = numBins; b < fftSize; ++b)
+            bins[b] = std::conj(accumulator[static_cast<size_t>(fftSize - b)]);
+
+        fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+        // The second half is free of circular wrap-around
+        std::copy_n(fftBuffer.data() + partitionSize, partitionSize, outputRing[channel].data() + outputIndex);
+    }
+}
+
+bool ConvolutionReverb::continueBuildingResponse()
+{
+    // New requests restart the build; a loader holding the lock just defers the check
+    const int requested = responseRequests.load(std::memory_order_acquire);
+    std::unique_ptr<juce::AudioBuffer<float>> impulse;
+    bool checkedPending = false;
+    {
+        const juce::SpinLock::ScopedTryLockType lock(pendingLock);
+        if (lock.isLocked())
+        {
+            impulse = std::move(pendingImpulse);
+            checkedPending = true;
+        }
+    }
+
+    if (impulse != nullptr)
+    {
+        synthesisRequested.store(false);
+        startBuildingResponse(std::move(*impulse));
+        buildingRequest = requested;
+    }
+    else if (synthesisRequested.exchange(false) && !usingLoadedResponse.load())
+    {
+        startBuildingResponse(synthesizeResponse(synthesisRt60.load(), synthesisHighFrequencyRatio.load()));
+        buildingRequest = requested;
+    }
+
+    if (buildingResponse == nullptr)
+    {
+        // Nothing left to build, so every request seen so far has been served
+        if (checkedPending && responsesBuilt.load(std::memory_order_relaxed) != requested)
+        {
+            responsesBuilt.store(requested, std::memory_order_release);
+            workerProgress.signal();
+        }
+
+        return false;
+    }
+
+    auto& response = *buildingResponse;
+
+    // One partition per call so pending tail blocks are never held up for long
+    if (response.partitionsBuilt < response.numPartitions)
+    {
+        const int p = response.partitionsBuilt++;
+        const int start = headLength + p * partitionSize;
+        const int count = juce::jmin(partitionSize, response.impulse.getNumSamples() - start);
+
+        for (size_t channel = 0; channel < 2; ++channel)
+        {
+            std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+            std::copy_n(response.impulse.getReadPointer(static_cast<int>(channel), start), count, fftBuffer.data());
+
+            fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+            std::copy_n(reinterpret_cast<const Spectrum*>(fftBuffer.data()), numBins,
+                        response.partitions[channel].data() + p * numBins);
+        }
+
+        return true;
+    }
+
+    // Complete: hand the head to the audio thread's convolution and switch the tail over
+    const int headSamples = juce::jmin(headLength, response.impulse.getNumSamples());
+    juce::AudioBuffer<float> headImpulse(2, headSamples);
+
+    for (int channel = 0; channel < 2; ++channel)
+        juce::FloatVectorOperations::copy(headImpulse.getWritePointer(channel), response.impulse.getReadPointer(channel), headSamples);
+
+    head.loadImpulseResponse(std::move(headImpulse), currentSampleRate,
+                             juce::dsp::Convolution::Stereo::yes,
+                             juce::dsp::Convolution::Trim::no,
+                             juce::dsp::Convolution::Normalise::no);
+
+    responseSeconds.store(static_cast<float>(response.impulse.getNumSamples() / currentSampleRate));
+
+    // The previous response is freed here, on the worker
+    activeResponse = std::move(buildingResponse);
+
+    responsesBuilt.store(buildingRequest, std::memory_order_release);
+    workerProgress.signal();
+
+    return true;
+}
+
+void ConvolutionReverb::startBuildingResponse(juce::AudioBuffer<float>&& impulse)
+{
+    auto response = std::make_unique<Response>();
+    const int tailSamples = impulse.getNumSamples() - headLength;
+
+    response->numPartitions = juce::jlimit(0, maxPartitions, (tailSamples + partitionSize - 1) / partitionSize);
+
+    for (auto& partitions : response->partitions)
+        partitions.assign(static_cast<size_t>(response->numPartitions * numBins), Spectrum());
+
+    response->impulse = std::move(impulse);
+    buildingResponse = std::move(response);
+}
+
+juce::AudioBuffer<float> ConvolutionReverb::synthesizeResponse(float rt60Seconds, float highFrequencyRatio) const
+{
+    const int length = juce::jmax(headLength, static_cast<int>(rt60Seconds * currentSampleRate));
+    juce::AudioBuffer<float> impulse(2, length);
+
+    // Noise split into two bands with their own exponential decays, reaching
+    // -60 dB at rt60Seconds (lows) and rt60Seconds * highFrequencyRatio (highs)
+    const float lowDecay = std::pow(10.0f, -3.0f / static_cast<float>(rt60Seconds * currentSampleRate));
+    const float highDecay = std::pow(10.0f, -3.0f / static_cast<float>(rt60Seconds * highFrequencyRatio * currentSampleRate));
+    const float splitCoefficient = 1.0f - std::exp(-juce::MathConstants<float>::twoPi * 1500.0f / static_cast<float>(currentSampleRate));
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        // Separate seeds keep the channels decorrelated and the response repeatable
+        juce::Random random(0x5eed + channel);
+        auto* data = impulse.getWritePointer(channel);
+
+        float lowBand = 0.0f;
+        float lowGain = 1.0f;
+        float highGain = 1.0f;
+        double energy = 0.0;
+
+        for (int i = 0; i < length; ++i)
+        {
+            const float noise = random.nextFloat() * 2.0f - 1.0f;
+            lowBand += splitCoefficient * (noise - lowBand);
+
+            data[i] = lowBand * lowGain + (noise - lowBand) * highGain;
+            energy += static_cast<double>(data[i]) * data[i];
+
+            lowGain *= lowDecay;
+            highGain *= highDecay;
+        }
+
+        // Unit energy, so a white input comes out at roughly the level it went in
+        if (energy > 0.0)
+            juce::FloatVectorOperations::multiply(data, static_cast<float>(1.0 / std::sqrt(energy)), length);
+    }
+
+    return impulse;
+}
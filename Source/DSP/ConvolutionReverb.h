@@ -0,0 +1,137 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+
+/**
+ * Long impulse response convolution with the tail moved off the audio thread
+ * The head of the IR runs on the audio thread through a zero-latency
+ * juce::dsp::Convolution; the rest is uniformly partitioned and processed by
+ * a low-priority worker, so the callback cost does not grow with the IR
+ * length. The head spans one prepared block plus a partition, so every tail
+ * partition's input is complete before the host call that plays it starts.
+ * In non-realtime mode the audio thread waits for the worker instead of
+ * dropping late partitions, so offline renders are complete and repeatable
+ */
+class ConvolutionReverb : private juce::Thread
+{
+public:
+    static constexpr int partitionSize = 1024;
+    static constexpr int minHeadPartitions = 2;
+    static constexpr float maxResponseSeconds = 12.0f;
+
+    ConvolutionReverb();
+    ~ConvolutionReverb() override;
+
+    // Audio processing lifecycle
+    void prepare(double sampleRate, int maximumBlockSize);
+    void release();
+
+    // Stereo in-place processing, output is 100% wet. Pass nullptr for right on mono buffers
+    void process(float* left, float* right, int numSamples);
+
+    // Offline rendering: process() blocks until the tail and any pending response are ready
+    void setNonRealtime(bool isNonRealtime) { nonRealtime.store(isNonRealtime); }
+
+    // Synthetic stereo response built on the worker; ignored while a loaded IR is active
+    void setSyntheticResponse(float rt60Seconds, float highFrequencyRatio);
+
+    // Replace the response with an IR file's contents (message thread; resampled if needed)
+    void loadImpulseResponse(juce::AudioBuffer<float>&& impulse, double impulseSampleRate);
+    void clearImpulseResponse();
+
+    float getTailLengthSeconds() const { return responseSeconds.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 2 * partitionSize;
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    using Spectrum = std::complex<float>;
+
+    // Partitioned tail spectra plus the head samples that go to the audio thread
+    struct Response
+    {
+        juce::AudioBuffer<float> impulse;
+        std::array<std::vector<Spectrum>, 2> partitions;
+        int numPartitions = 0;
+        int partitionsBuilt = 0;
+    };
+
+    // Head and ring sizes, fixed at prepare time. Tail partition j is computed
+    // from input partition j - headPartitions
+    int headPartitions = minHeadPartitions;
+    int headLength = minHeadPartitions * partitionSize;
+    int ringBlocks = 8;
+    int ringMask = 8 * partitionSize - 1;
+
+    // Audio thread: zero-latency head
+    juce::dsp::Convolution head;
+    juce::int64 samplePosition = 0;
+    juce::int64 tailValidFrom = 0;
+    bool tailBlockReady = false;
+    bool inputBlockWritable = true;
+    std::atomic<bool> nonRealtime { false };
+
+    // Shared rings, single producer and single consumer each way: the audio
+    // thread writes input and reads tail output, the worker does the opposite,
+    // and the block counters publish progress. Neither side touches a slot
+    // the other may still be using; a worker too far behind loses its input
+    // from restartBlock on instead, and the tail picks up again from there
+    std::array<std::vector<float>, 2> inputRing, outputRing;
+    std::atomic<juce::int64> blocksWritten { 0 };
+    std::atomic<juce::int64> blocksProcessed { 0 };
+    std::atomic<juce::int64> restartBlock { 0 };
+    juce::WaitableEvent workerProgress;
+
+    // Worker: frequency-domain delay line of input spectra and the active response
+    juce::dsp::FFT fft { fftOrder };
+    std::array<std::vector<Spectrum>, 2> inputSpectra;
+    std::vector<float> fftBuffer;
+    std::vector<Spectrum> accumulator;
+    int spectrumIndex = 0;
+    int maxPartitions = 0;
+    juce::int64 historyStart = 0;
+    std::unique_ptr<Response> activeResponse, buildingResponse;
+
+    // Every response request bumps responseRequests; the worker publishes the
+    // latest request it has fully served, so offline renders can wait for it
+    std::atomic<int> responseRequests { 0 };
+    std::atomic<int> responsesBuilt { 0 };
+    int buildingRequest = 0;
+
+    // Response hand-over. The worker only ever try-locks, so a loader holding the
+    // lock delays a swap by one partition rather than stalling the tail
+    juce::SpinLock pendingLock;
+    std::unique_ptr<juce::AudioBuffer<float>> pendingImpulse;
+    std::atomic<bool> synthesisRequested { false };
+    std::atomic<bool> usingLoadedResponse { false };
+    std::atomic<float> synthesisRt60 { 4.5f };
+    std::atomic<float> synthesisHighFrequencyRatio { 0.5f };
+    std::atomic<float> responseSeconds { 0.0f };
+
+    // Last loaded IR at its own rate, kept so a new sample rate can re-queue it
+    std::unique_ptr<juce::AudioBuffer<float>> loadedImpulse;
+    double loadedSampleRate = 44100.0;
+
+    // Processing state
+    double currentSampleRate = 44100.0;
+    bool isPrepared = false;
+
+    void queueLoadedResponse();
+    void requestResponse();
+    void waitForWorker(juce::int64 block);
+
+    // Worker thread
+    void run() override;
+    void processTailBlock(juce::int64 block);
+    bool continueBuildingResponse();
+    void startBuildingResponse(juce::AudioBuffer<float>&& impulse);
+    juce::AudioBuffer<float> synthesizeResponse(float rt60Seconds, float highFrequencyRatio) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
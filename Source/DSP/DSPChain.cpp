@@ -1,5 +1,18 @@
 #include "DSPChain.h"
 
+namespace
+{
+    // The chain's shaper has no separate tube screamer curve; it plays as soft clip
+    int toShaperIndex(DriveType type)
+    {
+        if (type == DriveType::HardClip)
+            return 1;
+        if (type == DriveType::Fuzz)
+            return 2;
+        return 0;
+    }
+}
+
 DSPChain::DSPChain()
 {
     // Initialize with default bypass state
@@ -15,53 +28,78 @@ void DSPChain::prepareToPlay(double sampleRate, int samplesPerBlock)
     currentSampleRate = sampleRate;
     currentSamplesPerBlock = samplesPerBlock;
 
-    // Initialize gain processor
-    gainProcessor.reset(sampleRate, 0.05); // 50ms ramp time
-    gainProcessor.setCurrentAndTargetValue(1.0f);
+    // Stages take their storage from the arena as they prepare, so it starts empty
+    scratchArena.reset();
 
-    // Initialize tone filters
-    updateToneFilter();
+    // Initialize noise gate
+    noiseGate.prepareToPlay(sampleRate, samplesPerBlock, 2, scratchArena);
+
+    // Initialize multiband dynamics with the latest preset settings, or its
+    // default low-end tightening
+    multibandDynamics.prepareToPlay(sampleRate, samplesPerBlock, 2, scratchArena);
+    {
+        const juce::SpinLock::ScopedLockType lock(multibandLock);
+        multibandDynamics.applyParameters(pendingMultiband);
+        hasPendingMultiband.store(false, std::memory_order_relaxed);
+    }
+
+    // Initialize compressor; the first block takes its settings from the smoother
+    compressor.prepareToPlay(sampleRate, samplesPerBlock, 2);
+    compressor.setLookahead(0.0f);
+
+    // Initialize tone filter; the first block designs it from the smoothed tone
+    toneFilter.reset();
+    lastToneValue = -1.0f;
 
     // Initialize drive/distortion
     driveGain.prepare({sampleRate, (juce::uint32)samplesPerBlock, 2});
-    driveShaper.prepare({sampleRate, (juce::uint32)samplesPerBlock, 2});
-    driveShaper.functionToUse = [](float input) {
-        // Soft clipping
-        return juce::jlimit(-0.95f, 0.95f, input * (1.0f + input * input * 0.5f));
-    };
 
-    // Initialize reverb delay buffer (instance-specific)
-    int reverbBufferSize = static_cast<int>(sampleRate * 0.1); // 100ms at current sample rate
-    reverbDelayBuffer.setSize(2, reverbBufferSize, false, true, false); // Clear the buffer
-    reverbDelayIndex = 0;
+    // Initialize the drive section's eq and its oversampling regions. The
+    // stages are prepared at the rate the regions run them at
+    equalizer.prepareToPlay(sampleRate, samplesPerBlock, 2);
+    equalizer.setAnalogStageExternal(true);
+    equalizerBandsValid = false;
+
+    for (auto& region : oversamplingRegions)
+        region.prepare(sampleRate, samplesPerBlock, 2);
+
+    driveShaper.prepareNonlinear(oversamplingRegions[0].getOversampledRate(), OversamplingRegion::factor * samplesPerBlock);
+    equalizer.prepareNonlinear(oversamplingRegions[0].getOversampledRate(), OversamplingRegion::factor * samplesPerBlock);
+
+    // Initialize reverb; it stays off until its mix comes up
+    reverb.prepareToPlay(sampleRate, samplesPerBlock, 2);
+    reverb.setEnabled(false);
 
     // Initialize delay
-    delayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 2.0)); // 2 second max delay
-    delayLine.setDelay(static_cast<float>(sampleRate * 0.25)); // 250ms default
-    delayMixer.prepare({sampleRate, (juce::uint32)samplesPerBlock, 2});
-    delayMixer.setWetMixProportion(0.0f);
+    delayEngine.prepare(sampleRate, 2, maxDelaySeconds);
+    delayEngine.setDelayTime(0.25f); // 250ms default
+    delayEngine.setFeedback(delayFeedback);
+    delayEngine.setInterpolationQuality(FractionalDelay::Quality::Cubic);
+    delayEngine.setMix(0.0f);
+
+    // Sidechain key analysis buffer
+    sidechainKey.prepare(samplesPerBlock);
 
     // Initialize chorus
-    chorusProcessor.prepare({sampleRate, (juce::uint32)samplesPerBlock, 2});
+    chorusProcessor.prepareToPlay(sampleRate, samplesPerBlock, 2);
     chorusProcessor.setRate(0.5f);
     chorusProcessor.setDepth(0.5f);
-    chorusProcessor.setCentreDelay(7.0f);
+    chorusProcessor.setDelay(7.0f);
     chorusProcessor.setFeedback(0.0f);
     chorusProcessor.setMix(0.0f);
 
     // Initialize EQ filters
-    highPassFilterL.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-    highPassFilterR.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-    lowPassFilterL.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-    lowPassFilterR.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-    midFilterL.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-    midFilterR.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-
-    // Set initial EQ parameters
-    updateEQFilters();
+    for (auto& filter : eqFilters)
+        filter.reset();
+
+    // Set initial EQ parameters from the smoother's defaults
+    lastEQLow = getParamInfo(ParamID::EQLow).defaultValue;
+    lastEQMid = getParamInfo(ParamID::EQMid).defaultValue;
+    lastEQHigh = getParamInfo(ParamID::EQHigh).defaultValue;
+    updateEQFilters(lastEQLow, lastEQMid, lastEQHigh);
 }
 
-void DSPChain::processBlock(juce::AudioBuffer<float>& buffer)
+void DSPChain::processBlock(juce::AudioBuffer<float>& buffer, const ParameterSmoother& smoothed)
 {
     if (bypassed)
         return;
@@ -70,203 +108,254 @@ void DSPChain::processBlock(juce::AudioBuffer<float>& buffer)
     if (buffer.getNumChannels() == 0 || buffer.getNumSamples() == 0)
         return;
 
-    // Update parameters with safety clamping
-    auto gainValue = juce::jlimit(0.0f, 2.0f, gainParameter.load());
-    auto driveValue = juce::jlimit(0.0f, 1.0f, driveParameter.load());
-    auto reverbMixValue = juce::jlimit(0.0f, 1.0f, reverbMixParameter.load());
-    auto reverbDecayValue = juce::jlimit(0.0f, 1.0f, reverbDecayParameter.load());
+    // Update parameters with safety clamping. Continuous parameters come
+    // from the smoother at their end-of-block values, except where a stage
+    // reads the ramp itself
+    auto blockValue = [&smoothed](ParamID id) { return smoothed.getBlockValues(id).value; };
+    auto driveValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::Drive));
+    auto reverbMixValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::ReverbMix));
     
-    gainProcessor.setTargetValue(gainValue);
+    // Gate the input before anything adds gain to its noise floor
+    noiseGate.setEnabled(gateEnabledParameter.load());
+    noiseGate.setGateMode(gateModeParameter.load());
+    noiseGate.setRhythmicPattern(gatePatternParameter.load(), gateStepsParameter.load());
+    noiseGate.setRhythmicSmoothing(gateSmoothingParameter.load());
+    noiseGate.setRhythmicDepth(gateDepthParameter.load());
+    noiseGate.setThreshold(juce::jlimit(-90.0f, 0.0f, blockValue(ParamID::GateThreshold)));
+    noiseGate.setTransport(transport.ppqPosition, transport.bpm, transport.isPlaying);
+    noiseGate.processBlock(buffer, getSidechainKey());
     
-    // Check if tone parameter changed
-    static float lastToneValue = -1.0f;
-    auto toneValue = toneParameter.load();
-    if (std::abs(toneValue - lastToneValue) > 0.001f)
-    {
-        updateToneFilter();
-        lastToneValue = toneValue;
-    }
+    if (hasPendingMultiband.load(std::memory_order_acquire))
+        applyPendingMultiband();
+    
+    multibandDynamics.setEnabled(multibandEnabledParameter.load());
+    multibandDynamics.processBlock(buffer);
+    
+    updateCompressor(smoothed);
+    compressor.processBlock(buffer);
     
     // Update drive gain
     driveGain.setGainLinear(1.0f + driveValue * 10.0f); // 1x to 11x gain
     
     // Update delay parameters with safety clamping
-    auto delayTimeValue = juce::jlimit(0.0f, 2.0f, delayTimeParameter.load());
-    auto delayMixValue = juce::jlimit(0.0f, 1.0f, delayMixParameter.load());
-    delayLine.setDelay(static_cast<float>(currentSampleRate * delayTimeValue));
-    delayMixer.setWetMixProportion(delayMixValue);
+    auto delayTimeValue = juce::jlimit(0.0f, maxDelaySeconds, blockValue(ParamID::DelayTime));
+    
+    // Synced delays take their time from the host tempo, worked out once per block;
+    // the engine crossfades to the new tap when the tempo moves. Free-running
+    // times glide at audio rate instead, like a tape delay's time knob
+    auto delayTimeChange = DelayEngine::TimeChange::Glide;
+    if (delaySyncParameter.load() && transport.bpm > 0.0)
+    {
+        auto division = static_cast<NoteDivision>(delayDivisionParameter.load());
+        auto syncedSeconds = noteDivisionToBeats(division) * 60.0 / transport.bpm;
+        delayTimeValue = juce::jlimit(0.0f, maxDelaySeconds, static_cast<float>(syncedSeconds));
+        delayTimeChange = DelayEngine::TimeChange::Crossfade;
+    }
+    
+    auto delayMixValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::DelayMix));
+    delayEngine.setDelayTime(delayTimeValue, delayTimeChange);
+    delayEngine.setMix(delayMixValue);
 
     // Update chorus parameters with safety clamping
-    auto chorusRateValue = juce::jlimit(0.1f, 5.0f, chorusRateParameter.load());
-    auto chorusMixValue = juce::jlimit(0.0f, 1.0f, chorusMixParameter.load());
+    auto chorusRateValue = juce::jlimit(0.1f, 5.0f, blockValue(ParamID::ChorusRate));
+    auto chorusMixValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::ChorusMix));
     chorusProcessor.setRate(chorusRateValue);
     chorusProcessor.setMix(chorusMixValue);
+    chorusProcessor.setVoices(chorusVoicesParameter.load());
 
     // Update EQ parameters with safety clamping
-    auto eqHighValue = juce::jlimit(0.0f, 1.0f, eqHighParameter.load());
-    auto eqMidValue = juce::jlimit(0.0f, 1.0f, eqMidParameter.load());
-    auto eqLowValue = juce::jlimit(0.0f, 1.0f, eqLowParameter.load());
+    auto eqHighValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::EQHigh));
+    auto eqMidValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::EQMid));
+    auto eqLowValue = juce::jlimit(0.0f, 1.0f, blockValue(ParamID::EQLow));
     
     // Check if EQ parameters changed
-    static float lastEQHigh = -1.0f, lastEQMid = -1.0f, lastEQLow = -1.0f;
     if (std::abs(eqHighValue - lastEQHigh) > 0.001f || 
         std::abs(eqMidValue - lastEQMid) > 0.001f || 
         std::abs(eqLowValue - lastEQLow) > 0.001f)
     {
-        updateEQFilters();
+        updateEQFilters(eqLowValue, eqMidValue, eqHighValue);
         lastEQHigh = eqHighValue;
         lastEQMid = eqMidValue;
         lastEQLow = eqLowValue;
     }
     
-    // Create DSP context
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
+    // Apply gain and tone filter
+    applyGainAndTone(buffer, smoothed);
     
-    // Process each channel with the full chain
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    // Apply drive/distortion if enabled, with the eq block on its preset side
+    updateEqualizer(smoothed);
+    driveShaper.setActive(driveValue > 0.001f);
+    driveShaper.setCurve(static_cast<DriveShaper::Curve>(driveTypeParameter.load()));
+    driveShaper.setCrossfade(static_cast<DriveShaper::Curve>(driveCrossfadeTypeParameter.load()),
+                             driveCrossfadeParameter.load());
+    processDriveSection(buffer);
+    
+    // Apply reverb if enabled
+    updateReverb(smoothed, reverbMixValue);
+    reverb.processBlock(buffer);
+    
+    // Apply delay if enabled (feedback and dry/wet mix are fused in the engine)
+    if (delayMixValue > 0.001f)
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        auto& toneFilter = (channel == 0) ? toneFilterL : toneFilterR;
-        
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            // Apply gain
-            float gainedSample = channelData[sample] * gainProcessor.getNextValue();
-            
-            // Apply tone filter
-            float tonedSample = toneFilter.processSample(gainedSample);
-            
-            // Apply drive/distortion if enabled
-            if (driveValue > 0.001f)
-            {
-                tonedSample = driveShaper.processSample(tonedSample);
-            }
-            
-            channelData[sample] = tonedSample;
-        }
+        delayEngine.process(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), buffer.getNumSamples());
     }
     
-    // Apply simple reverb if enabled
-    if (reverbMixValue > 0.001f)
+    // Apply chorus if enabled
+    if (chorusMixValue > 0.001f)
     {
-        // Store dry signal for mixing
-        juce::AudioBuffer<float> dryBuffer(buffer.getNumChannels(), buffer.getNumSamples());
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        {
-            dryBuffer.copyFrom(channel, 0, buffer, channel, 0, buffer.getNumSamples());
-        }
-
-        // Simple delay-based reverb effect using instance variables
-        const int delaySamples = reverbDelayBuffer.getNumSamples();
+        chorusProcessor.processBlock(buffer);
+    }
+    
+    // Apply EQ filters (simplified implementation); a mono buffer passes the same channel twice
+    float* left = buffer.getWritePointer(0);
+    float* right = (buffer.getNumChannels() > 1) ? buffer.getWritePointer(1) : left;
+    
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        float frame[2] = { left[sample], right[sample] };
+        
+        for (auto& filter : eqFilters)
+            filter.processSample(frame, frame);
+        
+        left[sample] = frame[0];
+        right[sample] = frame[1];
+    }
+}
 
-        for (int channel = 0; channel < juce::jmin(buffer.getNumChannels(), reverbDelayBuffer.getNumChannels()); ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            auto* delayData = reverbDelayBuffer.getWritePointer(channel);
-            int localDelayIndex = reverbDelayIndex;
+double DSPChain::getTailLengthSeconds() const
+{
+    // Each pass round the delay loop with gain g loses -20 log10(g) dB; count
+    // the passes to fall 60 dB
+    const double delayRingOut = maxDelaySeconds * -3.0 / std::log10(static_cast<double>(delayFeedback));
+    
+    return juce::jmax(reverb.getTailLengthSeconds(), delayRingOut);
+}
 
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                // Get delayed sample
-                float delayedSample = delayData[localDelayIndex];
+int DSPChain::getLatencyInSamples() const
+{
+    return noiseGate.getLatencyInSamples() + maxNonlinearRuns * OversamplingRegion::getLatencyInSamples();
+}
 
-                // Mix current sample with delayed sample
-                float reverbSample = channelData[sample] + delayedSample * reverbDecayValue * 0.3f;
+void DSPChain::reset()
+{
+    toneFilter.reset();
 
-                // Store in delay buffer
-                delayData[localDelayIndex] = reverbSample;
+    delayEngine.reset();
+    
+    for (auto& region : oversamplingRegions)
+        region.reset();
+}
 
-                // Update delay index
-                localDelayIndex = (localDelayIndex + 1) % delaySamples;
+void DSPChain::updateReverb(const ParameterSmoother& smoothed, float mix)
+{
+    // The Reverb redesigns its network only when a setting actually changes
+    ReverbParams params;
+    params.enabled = mix > 0.001f;
+    params.algorithm = static_cast<ReverbAlgorithm>(reverbAlgorithmParameter.load());
+    params.preDelayMs = smoothed.getBlockValues(ParamID::ReverbPreDelay).value;
+    params.decayS = 0.2f + 11.8f * juce::jlimit(0.0f, 1.0f, smoothed.getBlockValues(ParamID::ReverbDecay).value);
+    params.damping = smoothed.getBlockValues(ParamID::ReverbDamping).value;
+    params.mix = mix;
+    reverb.applyParameters(params);
+}
 
-                // Apply reverb mix
-                float dry = dryBuffer.getSample(channel, sample);
-                channelData[sample] = dry * (1.0f - reverbMixValue) + reverbSample * reverbMixValue;
-            }
-        }
+void DSPChain::updateCompressor(const ParameterSmoother& smoothed)
+{
+    CompressorParams params;
+    params.enabled = compressorEnabledParameter.load();
+    params.ratio = smoothed.getBlockValues(ParamID::CompressorRatio).value;
+    params.thresholdDb = smoothed.getBlockValues(ParamID::CompressorThreshold).value;
+    params.attackMs = smoothed.getBlockValues(ParamID::CompressorAttack).value;
+    params.releaseMs = smoothed.getBlockValues(ParamID::CompressorRelease).value;
+    params.makeupDb = smoothed.getBlockValues(ParamID::CompressorMakeup).value;
+    compressor.applyParameters(params);
+}
 
-        // Update the instance delay index once after processing
-        reverbDelayIndex = (reverbDelayIndex + buffer.getNumSamples()) % delaySamples;
+void DSPChain::processDriveSection(juce::AudioBuffer<float>& buffer)
+{
+    // The section's stages in chain order: the eq's filters are linear and
+    // its analog saturator is not, so an eq before the drive puts the two
+    // nonlinear stages side by side
+    struct SectionNode
+    {
+        NonlinearStage* nonlinear;     // null for the eq's filters
+    };
+    
+    const auto placement = static_cast<EqualizerPlacement>(equalizerPlacementParameter.load());
+    equalizer.setEnabled(placement != EqualizerPlacement::Off);
+    
+    std::array<SectionNode, 3> nodes {};
+    int numNodes = 0;
+    
+    if (placement == EqualizerPlacement::AfterDrive)
+        nodes[static_cast<size_t>(numNodes++)] = { &driveShaper };
+    
+    if (placement != EqualizerPlacement::Off)
+    {
+        nodes[static_cast<size_t>(numNodes++)] = { nullptr };
+        nodes[static_cast<size_t>(numNodes++)] = { &equalizer };
     }
     
-    // Apply delay if enabled
-    if (delayMixValue > 0.001f)
+    if (placement != EqualizerPlacement::AfterDrive)
+        nodes[static_cast<size_t>(numNodes++)] = { &driveShaper };
+    
+    // Walk the graph gathering runs of active nonlinear stages; inactive
+    // stages pass audio through untouched, so they do not break a run
+    const bool oversample = nonlinearOversamplingParameter.load();
+    std::array<NonlinearStage*, 3> run {};
+    int runLength = 0;
+    int regionIndex = 0;
+    
+    auto finishRun = [&]
     {
-        // Store dry signal for delay mixing
-        juce::AudioBuffer<float> dryBuffer(buffer.getNumChannels(), buffer.getNumSamples());
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        if (runLength == 0)
+            return;
+    
+        if (oversample)
         {
-            dryBuffer.copyFrom(channel, 0, buffer, channel, 0, buffer.getNumSamples());
+            oversamplingRegions[static_cast<size_t>(regionIndex++)].process(buffer, run.data(), runLength);
         }
-        
-        // Process delay
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        else
         {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float delayedSample = delayLine.popSample(channel, 0.0f);
-                float delayedWithFeedback = channelData[sample] + delayedSample * 0.3f; // 30% feedback
-                delayLine.pushSample(channel, delayedWithFeedback);
-                channelData[sample] = delayedWithFeedback;
-            }
+            for (int stage = 0; stage < runLength; ++stage)
+                run[static_cast<size_t>(stage)]->processNonlinear(buffer.getArrayOfWritePointers(),
+                                                                   buffer.getNumChannels(), buffer.getNumSamples());
         }
-        
-        // Mix dry and wet signals
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    
+        runLength = 0;
+    };
+    
+    for (int node = 0; node < numNodes; ++node)
+    {
+        auto* stage = nodes[static_cast<size_t>(node)].nonlinear;
+    
+        if (stage == nullptr)
+        {
+            finishRun();
+            equalizer.processBlock(buffer);
+        }
+        else if (stage->isNonlinearActive())
         {
-            auto* channelData = buffer.getWritePointer(channel);
-            auto* dryData = dryBuffer.getWritePointer(channel);
-            
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float dry = dryData[sample];
-                float wet = channelData[sample];
-                channelData[sample] = dry * (1.0f - delayMixValue) + wet * delayMixValue;
-            }
+            run[static_cast<size_t>(runLength++)] = stage;
         }
     }
     
-    // Apply chorus if enabled
-    if (chorusMixValue > 0.001f)
-    {
-        chorusProcessor.process(context);
-    }
+    finishRun();
     
-    // Apply EQ filters (simplified implementation)
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    // Every region stays in the path, so the section's latency holds whatever
+    // runs: one with no run this block filters the audio through on its own,
+    // and without oversampling each is a plain delay of the same length
+    for (; regionIndex < maxNonlinearRuns; ++regionIndex)
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        auto& highPass = (channel == 0) ? highPassFilterL : highPassFilterR;
-        auto& lowPass = (channel == 0) ? lowPassFilterL : lowPassFilterR;
-        auto& mid = (channel == 0) ? midFilterL : midFilterR;
-        
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            float sampleValue = channelData[sample];
-            
-            // Apply EQ chain
-            sampleValue = highPass.processSample(sampleValue);
-            sampleValue = mid.processSample(sampleValue);
-            sampleValue = lowPass.processSample(sampleValue);
-            
-            channelData[sample] = sampleValue;
-        }
+        auto& region = oversamplingRegions[static_cast<size_t>(regionIndex)];
+    
+        if (oversample)
+            region.process(buffer, nullptr, 0);
+        else
+            region.delay(buffer);
     }
 }
 
-void DSPChain::reset()
-{
-    gainProcessor.reset(currentSampleRate, 0.05);
-    toneFilterL.reset();
-    toneFilterR.reset();
-
-    // Clear reverb delay buffer
-    reverbDelayBuffer.clear();
-    reverbDelayIndex = 0;
-}
-
 void DSPChain::setBypassed(bool shouldBeBypassed)
 {
     bypassed = shouldBeBypassed;
@@ -277,97 +366,117 @@ bool DSPChain::isBypassed() const
     return bypassed;
 }
 
-void DSPChain::setGain(float newGain)
+void DSPChain::setDriveType(DriveType type)
 {
-    gainParameter.store(juce::jlimit(0.0f, 2.0f, newGain));
+    driveTypeParameter.store(toShaperIndex(type));
+    driveCrossfadeParameter.store(0.0f);
 }
 
-void DSPChain::setTone(float newTone)
+void DSPChain::setDriveCrossfade(DriveType from, DriveType to, float amount)
 {
-    toneParameter.store(juce::jlimit(0.0f, 1.0f, newTone));
+    driveTypeParameter.store(toShaperIndex(from));
+    driveCrossfadeTypeParameter.store(toShaperIndex(to));
+    driveCrossfadeParameter.store(juce::jlimit(0.0f, 1.0f, amount));
 }
 
-void DSPChain::setDrive(float newDrive)
+void DSPChain::setNonlinearOversampling(bool shouldOversample)
 {
-    driveParameter.store(juce::jlimit(0.0f, 1.0f, newDrive));
+    nonlinearOversamplingParameter.store(shouldOversample);
 }
 
-void DSPChain::setDriveType(const juce::String& type)
+void DSPChain::setEqualizerPlacement(EqualizerPlacement placement)
 {
-    // Convert string to int for atomic storage
-    int typeIndex = 0; // default to softclip
-    if (type == "hardclip")
-        typeIndex = 1;
-    else if (type == "fuzz")
-        typeIndex = 2;
-    
-    driveTypeParameter.store(typeIndex);
-    
-    // Update the waveshaper function based on type
-    if (type == "hardclip")
-    {
-        driveShaper.functionToUse = [](float input) {
-            return juce::jlimit(-0.95f, 0.95f, input);
-        };
-    }
-    else if (type == "fuzz")
-    {
-        driveShaper.functionToUse = [](float input) {
-            // Aggressive fuzz
-            return juce::jlimit(-0.95f, 0.95f, input * (1.0f + input * input * 2.0f));
-        };
-    }
-    else // default to softclip
-    {
-        driveShaper.functionToUse = [](float input) {
-            return juce::jlimit(-0.95f, 0.95f, input * (1.0f + input * input * 0.5f));
-        };
-    }
+    equalizerPlacementParameter.store(static_cast<int>(placement));
+}
+
+void DSPChain::setEqualizerMidDynamic(bool shouldBeDynamic)
+{
+    equalizerMidDynamicParameter.store(shouldBeDynamic);
 }
 
-void DSPChain::setReverbMix(float newMix)
+void DSPChain::setEqualizerAnalogModeling(bool shouldModel)
 {
-    reverbMixParameter.store(juce::jlimit(0.0f, 1.0f, newMix));
+    equalizerAnalogParameter.store(shouldModel);
 }
 
-void DSPChain::setReverbDecay(float newDecay)
+void DSPChain::setDelaySync(bool shouldSync)
 {
-    reverbDecayParameter.store(juce::jlimit(0.0f, 1.0f, newDecay));
+    delaySyncParameter.store(shouldSync);
 }
 
-void DSPChain::setDelayMix(float newMix)
+void DSPChain::setDelayDivision(NoteDivision newDivision)
 {
-    delayMixParameter.store(juce::jlimit(0.0f, 1.0f, newMix));
+    delayDivisionParameter.store(static_cast<int>(newDivision));
 }
 
-void DSPChain::setDelayTime(float newTime)
+void DSPChain::setChorusVoices(int voices)
 {
-    delayTimeParameter.store(juce::jlimit(0.0f, 2.0f, newTime));
+    chorusVoicesParameter.store(voices);
 }
 
-void DSPChain::setChorusMix(float newMix)
+void DSPChain::setReverbAlgorithm(ReverbAlgorithm algorithm)
 {
-    chorusMixParameter.store(juce::jlimit(0.0f, 1.0f, newMix));
+    reverbAlgorithmParameter.store(static_cast<int>(algorithm));
 }
 
-void DSPChain::setChorusRate(float newRate)
+void DSPChain::setNonRealtime(bool isNonRealtime)
 {
-    chorusRateParameter.store(juce::jlimit(0.1f, 5.0f, newRate));
+    reverb.setNonRealtime(isNonRealtime);
 }
 
-void DSPChain::setEQHigh(float newHigh)
+void DSPChain::setGateEnabled(bool shouldBeEnabled)
 {
-    eqHighParameter.store(juce::jlimit(0.0f, 1.0f, newHigh));
+    gateEnabledParameter.store(shouldBeEnabled);
 }
 
-void DSPChain::setEQMid(float newMid)
+void DSPChain::setGateMode(int mode)
 {
-    eqMidParameter.store(juce::jlimit(0.0f, 1.0f, newMid));
+    gateModeParameter.store(mode);
 }
 
-void DSPChain::setEQLow(float newLow)
+void DSPChain::setGatePattern(juce::uint32 stepMask, int numSteps)
 {
-    eqLowParameter.store(juce::jlimit(0.0f, 1.0f, newLow));
+    gatePatternParameter.store(stepMask);
+    gateStepsParameter.store(numSteps);
+}
+
+void DSPChain::setGateSmoothing(float fractionOfStep)
+{
+    gateSmoothingParameter.store(fractionOfStep);
+}
+
+void DSPChain::setGateDepth(float depth)
+{
+    gateDepthParameter.store(depth);
+}
+
+void DSPChain::setMultibandEnabled(bool shouldBeEnabled)
+{
+    multibandEnabledParameter.store(shouldBeEnabled);
+}
+
+void DSPChain::setCompressorEnabled(bool shouldBeEnabled)
+{
+    compressorEnabledParameter.store(shouldBeEnabled);
+}
+
+void DSPChain::setMultibandParameters(const MultibandDynamicsParams& params)
+{
+    const juce::SpinLock::ScopedLockType lock(multibandLock);
+    pendingMultiband = params;
+    hasPendingMultiband.store(true, std::memory_order_release);
+}
+
+void DSPChain::applyPendingMultiband()
+{
+    // If the message thread holds the lock, the settings are taken next block.
+    // The stage's on/off stays with the multiband_enabled parameter
+    const juce::SpinLock::ScopedTryLockType lock(multibandLock);
+    if (!lock.isLocked())
+        return;
+    
+    hasPendingMultiband.store(false, std::memory_order_relaxed);
+    multibandDynamics.applyParameters(pendingMultiband);
 }
 
 void DSPChain::updateFromPreset(const PresetData& preset)
@@ -375,57 +484,136 @@ void DSPChain::updateFromPreset(const PresetData& preset)
     // This is a simplified version - in the full implementation,
     // we would parse the preset and update all effect parameters
     
-    // For now, just set some basic parameters
-    setGain(1.0f);
-    setTone(0.5f);
-    
     // TODO: Parse preset.chain and configure all effects
     juce::ignoreUnused(preset);
 }
 
-void DSPChain::updateToneFilter()
+void DSPChain::applyGainAndTone(juce::AudioBuffer<float>& buffer, const ParameterSmoother& smoothed)
+{
+    const int numSamples = buffer.getNumSamples();
+    const auto gain = smoothed.getBlockValues(ParamID::Gain);
+    const auto tone = smoothed.getBlockValues(ParamID::Tone);
+    
+    // Gain: a ramp multiplies sample by sample, a constant scales the block
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        if (gain.isRamping())
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), gain.ramp, numSamples);
+        else
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), gain.value, numSamples);
+    }
+    
+    // Tone: left and right advance together; a mono buffer passes the same channel twice
+    float* left = buffer.getWritePointer(0);
+    float* right = (buffer.getNumChannels() > 1) ? buffer.getWritePointer(1) : left;
+    
+    auto filterSpan = [this](float* l, float* r, int length)
+    {
+        for (int i = 0; i < length; ++i)
+        {
+            float frame[2] = { l[i], r[i] };
+            toneFilter.processSample(frame, frame);
+            l[i] = frame[0];
+            r[i] = frame[1];
+        }
+    };
+    
+    if (tone.isRamping())
+    {
+        for (int start = 0; start < numSamples; start += toneUpdateInterval)
+        {
+            const int length = juce::jmin(toneUpdateInterval, numSamples - start);
+            updateToneFilter(tone.ramp[start + length - 1]);
+            filterSpan(left + start, right + start, length);
+        }
+    
+        lastToneValue = tone.value;
+    }
+    else
+    {
+        if (tone.value != lastToneValue)
+        {
+            updateToneFilter(tone.value);
+            lastToneValue = tone.value;
+        }
+    
+        filterSpan(left, right, numSamples);
+    }
+}
+
+void DSPChain::updateToneFilter(float toneValue)
 {
     // Simple tone control using a low-pass filter
     // toneValue: 0.0 = dark, 1.0 = bright
-    auto toneValue = toneParameter.load();
+    toneValue = juce::jlimit(0.0f, 1.0f, toneValue);
     
     // Calculate cutoff frequency (500Hz to 8kHz range)
     float cutoffFreq = 500.0f + (toneValue * 7500.0f);
     
-    // Create filter coefficients
-    auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(
-        currentSampleRate, cutoffFreq, 0.707f);
+    // Same coefficients for both channel lanes
+    const auto coefficients = BiquadCoefficients::lowPass(currentSampleRate, cutoffFreq, 0.707);
+    toneFilter.setLane(0, coefficients);
+    toneFilter.setLane(1, coefficients);
+}
+
+void DSPChain::updateEqualizer(const ParameterSmoother& smoothed)
+{
+    // The bands are redesigned only when one of them or a switch moves
+    const bool midDynamic = equalizerMidDynamicParameter.load();
+    const bool analogModeling = equalizerAnalogParameter.load();
+    bool changed = !equalizerBandsValid || midDynamic != lastEqualizerMidDynamic
+                                        || analogModeling != lastEqualizerAnalog;
+    lastEqualizerMidDynamic = midDynamic;
+    lastEqualizerAnalog = analogModeling;
+    
+    for (size_t band = 0; band < equalizerBandIDs.size(); ++band)
+    {
+        const float value = smoothed.getBlockValues(equalizerBandIDs[band]).value;
+        changed = changed || value != lastEqualizerBands[band];
+        lastEqualizerBands[band] = value;
+    }
+    
+    if (!changed)
+        return;
+    
+    EqualizerParams params;
+    params.lowShelfHz = lastEqualizerBands[0];
+    params.lowGainDb = lastEqualizerBands[1];
+    params.midHz = lastEqualizerBands[2];
+    params.midQ = lastEqualizerBands[3];
+    params.midGainDb = lastEqualizerBands[4];
+    params.highShelfHz = lastEqualizerBands[5];
+    params.highGainDb = lastEqualizerBands[6];
+    params.midDynamicThresholdDb = lastEqualizerBands[7];
+    params.midDynamicRangeDb = lastEqualizerBands[8];
+    params.midDynamic = midDynamic;
+    params.analogModeling = analogModeling;
     
-    // Update both channel filters
-    toneFilterL.coefficients = coeffs;
-    toneFilterR.coefficients = coeffs;
+    // On/off follows the placement, set by the drive section each block
+    params.enabled = equalizer.isEnabled();
+    equalizer.applyParameters(params);
+    equalizerBandsValid = true;
 }
 
-void DSPChain::updateEQFilters()
+void DSPChain::updateEQFilters(float eqLowValue, float eqMidValue, float eqHighValue)
 {
-    auto eqHighValue = eqHighParameter.load();
-    auto eqMidValue = eqMidParameter.load();
-    auto eqLowValue = eqLowParameter.load();
+    // Designed in place like the tone filter, the same for both lanes
+    auto setFilter = [this](size_t row, const BiquadCoefficients& coefficients)
+    {
+        eqFilters[row].setLane(0, coefficients);
+        eqFilters[row].setLane(1, coefficients);
+    };
     
     // High-pass filter (removes low frequencies)
     float highPassFreq = 20.0f + eqLowValue * 2000.0f; // 20Hz to 2kHz
-    auto highPassCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighPass(
-        currentSampleRate, highPassFreq, 0.707f);
-    highPassFilterL.coefficients = highPassCoeffs;
-    highPassFilterR.coefficients = highPassCoeffs;
-    
-    // Low-pass filter (removes high frequencies)
-    float lowPassFreq = 2000.0f + eqHighValue * 18000.0f; // 2kHz to 20kHz
-    auto lowPassCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(
-        currentSampleRate, lowPassFreq, 0.707f);
-    lowPassFilterL.coefficients = lowPassCoeffs;
-    lowPassFilterR.coefficients = lowPassCoeffs;
+    setFilter(0, BiquadCoefficients::highPass(currentSampleRate, highPassFreq, 0.707));
     
     // Mid filter (parametric boost/cut around 1kHz)
     float midFreq = 1000.0f;
     float midGain = (eqMidValue - 0.5f) * 12.0f; // -6dB to +6dB
-    auto midCoeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        currentSampleRate, midFreq, 0.7f, juce::Decibels::decibelsToGain(midGain));
-    midFilterL.coefficients = midCoeffs;
-    midFilterR.coefficients = midCoeffs;
+    setFilter(1, BiquadCoefficients::peaking(currentSampleRate, midFreq, 0.7, midGain));
+    
+    // Low-pass filter (removes high frequencies)
+    float lowPassFreq = 2000.0f + eqHighValue * 18000.0f; // 2kHz to 20kHz
+    setFilter(2, BiquadCoefficients::lowPass(currentSampleRate, lowPassFreq, 0.707));
 }
\ No newline at end of file
@@ -3,6 +3,19 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "../Preset/PresetSchema.h"
+#include "DelayEngine.h"
+#include "Chorus.h"
+#include "SidechainKey.h"
+#include "NoiseGate.h"
+#include "Compressor.h"
+#include "MultibandDynamics.h"
+#include "DriveShaper.h"
+#include "Equalizer.h"
+#include "OversamplingRegion.h"
+#include "Reverb.h"
+#include "SIMDBiquad.h"
+#include "../Utils/ScratchArena.h"
+#include "../Utils/ParameterSmoother.h"
 
 /**
  * Simplified DSP processing chain for basic audio processing
@@ -16,79 +29,193 @@ public:
     
     // Audio processing
     void prepareToPlay(double sampleRate, int samplesPerBlock);
-    void processBlock(juce::AudioBuffer<float>& buffer);
+    // Gain and tone come from the smoother's block values, already advanced
+    // over this block
+    void processBlock(juce::AudioBuffer<float>& buffer, const ParameterSmoother& smoothed);
     void reset();
     
+    // Host transport, read once per block by the processor (audio thread only)
+    struct TransportState
+    {
+        double bpm = 120.0;
+        double ppqPosition = 0.0;
+        bool isPlaying = false;
+    };
+    
+    void setTransport(const TransportState& newTransport) { transport = newTransport; }
+    
+    // External sidechain for this block (audio thread only). The channels are
+    // the host's own; zero channels means the bus is off
+    void setSidechainInput(const float* const* channels, int numChannels, int numSamples)
+    {
+        sidechainKey.setInput(channels, numChannels, numSamples);
+    }
+    
+    // Key for dynamics stages, analysed once per block on first use; null when no sidechain is routed
+    SidechainKey* getSidechainKey() { return sidechainKey.isActive() ? &sidechainKey : nullptr; }
+    
+    // Where the preset's eq block sits relative to the drive, if it has one
+    enum class EqualizerPlacement
+    {
+        Off,
+        BeforeDrive,
+        AfterDrive
+    };
+    
     // Bypass control
     void setBypassed(bool shouldBeBypassed);
     bool isBypassed() const;
     
-    // Parameter control
-    void setGain(float newGain);
-    void setTone(float newTone);
-    void setDrive(float newDrive);
-    void setDriveType(const juce::String& type);
-    void setReverbMix(float newMix);
-    void setReverbDecay(float newDecay);
-    void setDelayMix(float newMix);
-    void setDelayTime(float newTime);
-    void setChorusMix(float newMix);
-    void setChorusRate(float newRate);
-    void setEQHigh(float newHigh);
-    void setEQMid(float newMid);
-    void setEQLow(float newLow);
+    // Parameter control. These are the discrete settings; every continuous
+    // parameter is read from the ParameterSmoother given to processBlock
+    void setGateEnabled(bool shouldBeEnabled);
+    void setGateMode(int mode);     // 0=gate, 1=duck (keyed by the sidechain), 2=rhythmic
+    void setGatePattern(juce::uint32 stepMask, int numSteps);   // one bit per step, 16 or 32 steps
+    void setGateSmoothing(float fractionOfStep);                // 0 to 0.5
+    void setGateDepth(float depth);                             // 0 to 1
+    void setMultibandEnabled(bool shouldBeEnabled);
+    void setMultibandParameters(const MultibandDynamicsParams& params);   // bands and crossovers, taken at the next block
+    void setCompressorEnabled(bool shouldBeEnabled);
+    void setDriveType(DriveType type);
+    void setNonlinearOversampling(bool shouldOversample);
+    void setEqualizerPlacement(EqualizerPlacement placement);
+    void setEqualizerMidDynamic(bool shouldBeDynamic);
+    void setEqualizerAnalogModeling(bool shouldModel);
+    void setDelaySync(bool shouldSync);
+    void setDelayDivision(NoteDivision newDivision);
+    void setChorusVoices(int voices);
+    void setReverbAlgorithm(ReverbAlgorithm algorithm);
+    
+    // Offline rendering: stages with worker threads wait for them instead of dropping output
+    void setNonRealtime(bool isNonRealtime);
+    
+    // Blends the drive from one curve into another, 0 to 1, for preset morphing
+    void setDriveCrossfade(DriveType from, DriveType to, float amount);
     
     // Preset management (simplified)
     void updateFromPreset(const PresetData& preset);
     
+    // How long the output rings on after the input stops: the reverb at its
+    // current settings, or the delay at its longest
+    double getTailLengthSeconds() const;
+    
+    // Delay the chain adds to the signal, fixed once prepared
+    int getLatencyInSamples() const;
+    
 private:
     // Audio processing state
     double currentSampleRate = 44100.0;
     int currentSamplesPerBlock = 512;
     bool bypassed = false;
     
-    // Basic processing
-    juce::SmoothedValue<float> gainProcessor;
-    juce::dsp::IIR::Filter<float> toneFilterL, toneFilterR;
+    // Basic processing. The tone low-pass runs both channels as the lanes of
+    // one row; while the tone control ramps it is redesigned every
+    // toneUpdateInterval samples, otherwise only when the value changes
+    static constexpr int toneUpdateInterval = 32;
+    SIMDBiquad<2> toneFilter;
+    float lastToneValue = -1.0f;
+    
+    // Delay lines and block scratch for the stages, carved out once in prepareToPlay
+    ScratchArena scratchArena;
+    
+    // Noise gate at the head of the chain
+    NoiseGate noiseGate;
+    
+    // Multiband dynamics after the gate, tightening the low end before the drive
+    MultibandDynamics multibandDynamics;
+    
+    // Compressor evening out the level into the drive. It runs without
+    // lookahead, so it adds no latency
+    Compressor compressor;
     
     // Drive/distortion
     juce::dsp::Gain<float> driveGain;
-    juce::dsp::WaveShaper<float> driveShaper;
+    DriveShaper driveShaper;
+    
+    // Preset eq block, next to the drive. Its filters run as a linear stage
+    // of the drive section and its analog saturator as a nonlinear one
+    Equalizer equalizer;
+    
+    // Drive section: each run of adjacent active nonlinear stages shares one
+    // 2x region, so neighbours pay for a single pair of resampling filters.
+    // Both regions stay in the path, each adding OversamplingRegion::getLatencyInSamples()
+    static constexpr int maxNonlinearRuns = 2;
+    std::array<OversamplingRegion, maxNonlinearRuns> oversamplingRegions;
     
     // Delay effect
-    juce::dsp::DelayLine<float> delayLine;
-    juce::dsp::DryWetMixer<float> delayMixer;
+    DelayEngine delayEngine;
     
     // Chorus effect
-    juce::dsp::Chorus<float> chorusProcessor;
+    Chorus chorusProcessor;
+    
+    // Reverb after the drive section: the FDN algorithms or the convolution
+    Reverb reverb;
     
-    // EQ effect (simplified implementation)
-    juce::dsp::IIR::Filter<float> highPassFilterL, highPassFilterR;
-    juce::dsp::IIR::Filter<float> lowPassFilterL, lowPassFilterR;
-    juce::dsp::IIR::Filter<float> midFilterL, midFilterR;
+    // EQ effect (simplified implementation): high-pass, mid and low-pass rows
+    // in turn, left and right as the two lanes. Coefficients are designed
+    // straight into the rows, so a change never allocates
+    std::array<SIMDBiquad<2>, 3> eqFilters;
     
     // Atomic parameters for thread safety
-    std::atomic<float> gainParameter{1.0f};
-    std::atomic<float> toneParameter{0.5f};
-    std::atomic<float> driveParameter{0.0f};
+    std::atomic<bool> gateEnabledParameter{false};
+    std::atomic<int> gateModeParameter{0};
+    std::atomic<juce::uint32> gatePatternParameter{0x5555};
+    std::atomic<int> gateStepsParameter{16};
+    std::atomic<float> gateSmoothingParameter{0.1f};
+    std::atomic<float> gateDepthParameter{0.8f};
+    std::atomic<bool> multibandEnabledParameter{false};
+    std::atomic<bool> compressorEnabledParameter{false};
+    
+    // Multiband settings from the message thread, copied across under the lock
+    juce::SpinLock multibandLock;
+    MultibandDynamicsParams pendingMultiband;
+    std::atomic<bool> hasPendingMultiband{false};
     std::atomic<int> driveTypeParameter{0}; // 0=softclip, 1=hardclip, 2=fuzz
-    std::atomic<float> reverbMixParameter{0.0f};
-    std::atomic<float> reverbDecayParameter{0.5f};
-    std::atomic<float> delayMixParameter{0.0f};
-    std::atomic<float> delayTimeParameter{0.25f};
-    std::atomic<float> chorusMixParameter{0.0f};
-    std::atomic<float> chorusRateParameter{0.5f};
-    std::atomic<float> eqHighParameter{0.5f};
-    std::atomic<float> eqMidParameter{0.5f};
-    std::atomic<float> eqLowParameter{0.5f};
+    std::atomic<int> driveCrossfadeTypeParameter{0};
+    std::atomic<float> driveCrossfadeParameter{0.0f};
+    std::atomic<bool> nonlinearOversamplingParameter{true};
+    std::atomic<int> equalizerPlacementParameter{static_cast<int>(EqualizerPlacement::Off)};
+    std::atomic<bool> equalizerMidDynamicParameter{false};
+    std::atomic<bool> equalizerAnalogParameter{true};
+    std::atomic<bool> delaySyncParameter{false};
+    std::atomic<int> delayDivisionParameter{static_cast<int>(NoteDivision::Quarter)};
+    std::atomic<int> chorusVoicesParameter{1};
+    std::atomic<int> reverbAlgorithmParameter{static_cast<int>(ReverbAlgorithm::Plate)};
+    
+    // EQ values the filters were last designed for
+    float lastEQLow = -1.0f, lastEQMid = -1.0f, lastEQHigh = -1.0f;
+    
+    // Eq block bands and dynamic mid the Equalizer was last given, in the
+    // order of equalizerBandIDs, and its switches
+    static constexpr std::array<ParamID, 9> equalizerBandIDs {
+        ParamID::EQLowShelfFreq, ParamID::EQLowShelfGain, ParamID::EQMidFreq, ParamID::EQMidQ,
+        ParamID::EQMidGain, ParamID::EQHighShelfFreq, ParamID::EQHighShelfGain,
+        ParamID::EQDynamicThreshold, ParamID::EQDynamicRange
+    };
+    std::array<float, equalizerBandIDs.size()> lastEqualizerBands {};
+    bool lastEqualizerMidDynamic = false;
+    bool lastEqualizerAnalog = true;
+    bool equalizerBandsValid = false;
 
-    // Reverb state (instance-specific, not static!)
-    juce::AudioBuffer<float> reverbDelayBuffer{2, 4410}; // ~100ms at 44.1kHz
-    int reverbDelayIndex{0};
+    // Latest host transport
+    TransportState transport;
+    
+    // External sidechain key
+    SidechainKey sidechainKey;
+    
+    // Delay line feedback and length
+    static constexpr float maxDelaySeconds = 2.0f;
+    static constexpr float delayFeedback = 0.3f;
 
     // Helper methods
-    void updateToneFilter();
-    void updateEQFilters();
+    void updateToneFilter(float toneValue);
+    void applyGainAndTone(juce::AudioBuffer<float>& buffer, const ParameterSmoother& smoothed);
+    void updateEQFilters(float eqLowValue, float eqMidValue, float eqHighValue);
+    void updateEqualizer(const ParameterSmoother& smoothed);
+    void processDriveSection(juce::AudioBuffer<float>& buffer);
+    void updateReverb(const ParameterSmoother& smoothed, float mix);
+    void updateCompressor(const ParameterSmoother& smoothed);
+    void applyPendingMultiband();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DSPChain)
 };
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "Delay.h"
+
+Delay::Delay()
+{
+}
+
+Delay::~Delay()
+{
+}
+
+void Delay::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    juce::ignoreUnused(samplesPerBlock, numChannels);
+    currentSampleRate = sampleRate;
+    
+    // One interleaved ring holds both channels, so a long delay reads one stream
+    // of memory instead of two
+    maxDelayInSamples = msToSamples(maxDelaySeconds * 1000.0f);
+    bufferFrames = juce::nextPowerOfTwo(maxDelayInSamples + msToSamples(maxModulationMs) + FractionalDelay::numTaps);
+    bufferMask = bufferFrames - 1;
+    ring.assign(static_cast<size_t>(bufferFrames) * 2, 0.0f);
+    
+    // Mutually prime diffuser lengths (about 1.1 ms and 2.7 ms at 44.1 kHz)
+    prepareDiffuser(diffuser1, juce::jmax(1, static_cast<int>(sampleRate * 0.0011)) | 1);
+    prepareDiffuser(diffuser2, juce::jmax(1, static_cast<int>(sampleRate * 0.0027)) | 1);
+    
+    glideCoefficient = 1.0 - std::exp(-1.0 / (glideSeconds * sampleRate));
+    
+    updateFilters();
+    updateModulation();
+    updateDiffusion();
+    resetState();
+    
+    isPrepared = true;
+}
+
+void Delay::releaseResources()
+{
+    ring.clear();
+    ring.shrink_to_fit();
+    diffuser1.ring.clear();
+    diffuser2.ring.clear();
+    isPrepared = false;
+}
+
+void Delay::resetState()
+{
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    std::fill(diffuser1.ring.begin(), diffuser1.ring.end(), 0.0f);
+    std::fill(diffuser2.ring.begin(), diffuser2.ring.end(), 0.0f);
+    writeIndex = 0;
+    diffuser1.writeIndex = 0;
+    diffuser2.writeIndex = 0;
+    
+    highCutState = {};
+    lowCutState = {};
+    lfoSin = 0.0f;
+    lfoCos = 1.0f;
+    
+    // The ring is silent, so the first delay time applies without a glide
+    jumpToTarget = true;
+}
+
+void Delay::prepareDiffuser(Diffuser& diffuser, int lengthFrames)
+{
+    const int frames = juce::nextPowerOfTwo(lengthFrames + 1);
+    diffuser.ring.assign(static_cast<size_t>(frames) * 2, 0.0f);
+    diffuser.mask = frames - 1;
+    diffuser.length = lengthFrames;
+    diffuser.writeIndex = 0;
+}
+
+Delay::Frame Delay::processDiffuser(Diffuser& diffuser, Frame input, float gain)
+{
+    float* data = diffuser.ring.data();
+    const int read = 2 * ((diffuser.writeIndex - diffuser.length) & diffuser.mask);
+    const int write = 2 * diffuser.writeIndex;
+    
+    // v[n] = x[n] + g v[n - M], y[n] = v[n - M] - g v[n]
+    const Frame delayed { data[read], data[read + 1] };
+    const Frame v = input + delayed * gain;
+    data[write] = v.left;
+    data[write + 1] = v.right;
+    
+    diffuser.writeIndex = (diffuser.writeIndex + 1) & diffuser.mask;
+    return delayed - v * gain;
+}
+
+void Delay::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    if (!isPrepared || !enabled)
+        return;
+    
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    
+    if (numChannels == 0)
+        return;
+    
+    // Mono buffers run the right lane as a copy of the left and discard it
+    float* left = buffer.getWritePointer(0);
+    float* right = numChannels > 1 ? buffer.getWritePointer(1) : nullptr;
+    
+    updateDelayTime();
+    
+    if (jumpToTarget)
+    {
+        currentDelaySamples = targetDelaySamples;
+        jumpToTarget = false;
+    }
+    
+    // Block-rate copies keep the per-frame loop free of member reloads
+    float* data = ring.data();
+    const int mask = bufferMask;
+    const double target = targetDelaySamples;
+    const double glide = glideCoefficient;
+    const float depth = modulationSamples;
+    const float rotationSin = lfoRotationSin;
+    const float rotationCos = lfoRotationCos;
+    const float highCut = highCutCoefficient;
+    const float lowCut = lowCutCoefficient;
+    const float diffusionAmount = diffusionGain;
+    const bool diffuse = diffusionAmount > 0.0f;
+    const float feedbackGain = feedback;
+    const float wetAmount = mix;
+    const float spread = stereoSpread;
+    const auto quality = interpolationQuality;
+    
+    double delay = currentDelaySamples;
+    float sine = lfoSin;
+    float cosine = lfoCos;
+    Frame highCutFiltered = highCutState;
+    Frame lowCutFiltered = lowCutState;
+    int write = writeIndex;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Delay time: glide towards the target, plus the wow/flutter LFO
+        delay += glide * (target - delay);
+    
+        const float nextSine = sine * rotationCos + cosine * rotationSin;
+        cosine = cosine * rotationCos - sine * rotationSin;
+        sine = nextSine;
+    
+        const double readDelay = delay + static_cast<double>(depth * sine);
+        const int whole = static_cast<int>(readDelay);
+        const auto w = FractionalDelay::computeWeights(quality, 1.0f - static_cast<float>(readDelay - whole));
+    
+        // All four taps of both channels are eight neighbouring floats
+        const int index = write - whole - 1;
+        Frame delayed;
+    
+        for (int tap = 0; tap < FractionalDelay::numTaps; ++tap)
+        {
+            const float* frame = data + 2 * ((index + tap - 1) & mask);
+            delayed = delayed + Frame { frame[0], frame[1] } * w[static_cast<size_t>(tap)];
+        }
+    
+        // Tone of the repeats: one-pole high cut, then a one-pole low cut taken
+        // as the difference from its own lowpass
+        highCutFiltered = highCutFiltered + (delayed - highCutFiltered) * highCut;
+        lowCutFiltered = lowCutFiltered + (highCutFiltered - lowCutFiltered) * lowCut;
+        Frame wet = highCutFiltered - lowCutFiltered;
+    
+        if (diffuse)
+            wet = processDiffuser(diffuser2, processDiffuser(diffuser1, wet, diffusionAmount), diffusionAmount);
+    
+        const Frame dry { left[i], right != nullptr ? right[i] : left[i] };
+    
+        // Ping-pong: spread pans the input towards the left of the line and
+        // swaps the repeats between the lanes on the way back in
+        const float mono = 0.5f * (dry.left + dry.right);
+        const Frame lineInput { dry.left + spread * (mono - dry.left), dry.right * (1.0f - spread) };
+        const Frame crossed { wet.left + spread * (wet.right - wet.left), wet.right + spread * (wet.left - wet.right) };
+        const Frame line = lineInput + crossed * feedbackGain;
+    
+        data[2 * write] = line.left;
+        data[2 * write + 1] = line.right;
+        write = (write + 1) & mask;
+    
+        const Frame out = dry + (wet - dry) * wetAmount;
+        left[i] = out.left;
+    
+        if (right != nullptr)
+            right[i] = out.right;
+    }
+    
+    // Pull the oscillator back onto the unit circle once per block
+    const float magnitude = std::sqrt(sine * sine + cosine * cosine);
+    lfoSin = sine / magnitude;
+    lfoCos = cosine / magnitude;
+    
+    currentDelaySamples = delay;
+    highCutState = highCutFiltered;
+    lowCutState = lowCutFiltered;
+    writeIndex = write;
+    
+    // Extra channels get the left output
+    for (int channel = 2; channel < numChannels; ++channel)
+        buffer.copyFrom(channel, 0, buffer, 0, 0, numSamples);
+}
+
+void Delay::setDelayTime(float timeMs)
+{
+    delayTimeMs = juce::jlimit(40.0f, 1200.0f, timeMs);
+}
+
+void Delay::setFeedback(float newFeedback)
+{
+    feedback = juce::jlimit(0.0f, 0.95f, newFeedback);
+}
+
+void Delay::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void Delay::setModulationRate(float rateHz)
+{
+    modulationRate = juce::jlimit(0.0f, 2.0f, rateHz);
+    updateModulation();
+}
+
+void Delay::setModulationDepth(float depth)
+{
+    modulationDepth = juce::jlimit(0.0f, 1.0f, depth);
+    updateModulation();
+}
+
+void Delay::setHighCut(float cutoffHz)
+{
+    highCutHz = juce::jlimit(1000.0f, 20000.0f, cutoffHz);
+    updateFilters();
+}
+
+void Delay::setLowCut(float cutoffHz)
+{
+    lowCutHz = juce::jlimit(20.0f, 500.0f, cutoffHz);
+    updateFilters();
+}
+
+void Delay::setStereoSpread(float spread)
+{
+    stereoSpread = juce::jlimit(0.0f, 1.0f, spread);
+}
+
+void Delay::setDiffusion(float newDiffusion)
+{
+    diffusion = juce::jlimit(0.0f, 1.0f, newDiffusion);
+    updateDiffusion();
+}
+
+void Delay::setInterpolationQuality(FractionalDelay::Quality quality)
+{
+    interpolationQuality = quality;
+}
+
+void Delay::applyParameters(const DelayParams& params)
+{
+    setEnabled(params.enabled);
+    setDelayTime(params.timeMs);
+    setFeedback(params.feedback);
+    setMix(params.mix);
+    setTempoSync(params.tempoSync);
+    setNoteDivision(params.division);
+}
+
+void Delay::updateDelayTime()
+{
+    // The diffusers add their own length to every trip round the loop, so the
+    // read tap moves earlier by the same amount to keep repeats on time
+    const int diffusionSamples = (diffusionGain > 0.0f) ? diffuser1.length + diffuser2.length : 0;
+    const float modulation = modulationSamples;
+    
+    const int samples = msToSamples(getEffectiveDelayTimeMs()) - diffusionSamples;
+    const double lowest = minimumDelaySamples + modulation + 1.0;
+    const double highest = static_cast<double>(maxDelayInSamples);
+    targetDelaySamples = juce::jlimit(lowest, juce::jmax(lowest, highest), static_cast<double>(samples));
+}
+
+void Delay::updateFilters()
+{
+    auto onePole = [this](float cutoffHz)
+    {
+        const double limited = juce::jmin(static_cast<double>(cutoffHz), currentSampleRate * 0.45);
+        return static_cast<float>(1.0 - std::exp(-juce::MathConstants<double>::twoPi * limited / currentSampleRate));
+    };
+    
+    highCutCoefficient = onePole(highCutHz);
+    lowCutCoefficient = onePole(lowCutHz);
+}
+
+void Delay::updateModulation()
+{
+    const double angle = juce::MathConstants<double>::twoPi * modulationRate / currentSampleRate;
+    lfoRotationSin = static_cast<float>(std::sin(angle));
+    lfoRotationCos = static_cast<float>(std::cos(angle));
+    modulationSamples = modulationDepth * maxModulationMs * 0.001f * static_cast<float>(currentSampleRate);
+}
+
+void Delay::updateDiffusion()
+{
+    diffusionGain = diffusion * 0.7f;
+}
+
+int Delay::msToSamples(float ms) const
+{
+    return static_cast<int>(std::round(ms * 0.001 * currentSampleRate));
+}
+
+float Delay::samplesToMs(int samples) const
+{
+    return static_cast<float>(samples * 1000.0 / currentSampleRate);
+}
@@ -1,11 +1,15 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
 #include "../Preset/PresetSchema.h"
+#include "FractionalDelay.h"
+#include <vector>
 
 /**
  * Delay effect with feedback and modulation
- * Supports everything from slapback to infinite ambient delays
+ * Supports everything from slapback to infinite ambient delays.
+ * Both channels live in one interleaved L/R ring, so each frame is read,
+ * filtered, diffused and cross-fed as a single two-lane unit
  */
 class Delay
 {
@@ -33,13 +37,24 @@ public:
     void setLowCut(float cutoffHz);         // 20 to 500 Hz
     void setStereoSpread(float spread);     // 0 to 1 (ping-pong effect)
     void setDiffusion(float diffusion);     // 0 to 1 (smear the repeats)
+    void setInterpolationQuality(FractionalDelay::Quality quality);
     
     // Apply parameters from preset
     void applyParameters(const DelayParams& params);
     
-    // Tempo sync (for future implementation)
+    // Tempo sync: when on, the delay time follows the note division at the host tempo
     void setTempoSync(bool sync) { tempoSync = sync; }
-    void setBPM(double bpm) { currentBPM = bpm; }
+    void setNoteDivision(NoteDivision newDivision) { division = newDivision; }
+    void setBPM(double bpm) { if (bpm > 0.0) currentBPM = bpm; }
+    
+    // Delay time in use: the synced division at the current tempo, or delayTimeMs
+    float getEffectiveDelayTimeMs() const
+    {
+        if (!tempoSync)
+            return delayTimeMs;
+        
+        return static_cast<float>(noteDivisionToBeats(division) * 60000.0 / currentBPM);
+    }
     
 private:
     // Parameters
@@ -56,28 +71,73 @@ private:
     
     // Tempo sync
     bool tempoSync = false;
+    NoteDivision division = NoteDivision::Quarter;
     double currentBPM = 120.0;
     
-    // DSP components
-    juce::dsp::DelayLine<float> delayLineL, delayLineR;
-    juce::dsp::Oscillator<float> modulationLFO;
-    
-    // Filtering for analog character
-    juce::dsp::IIR::Filter<float> highCutFilterL, highCutFilterR;
-    juce::dsp::IIR::Filter<float> lowCutFilterL, lowCutFilterR;
+    // One interleaved L/R frame. The tone filters, diffusers and cross-feed
+    // apply the same coefficients to both lanes, so they work on whole frames
+    struct Frame
+    {
+        float left = 0.0f;
+        float right = 0.0f;
+        
+        Frame operator+(Frame other) const { return { left + other.left, right + other.right }; }
+        Frame operator-(Frame other) const { return { left - other.left, right - other.right }; }
+        Frame operator*(float gain) const { return { left * gain, right * gain }; }
+    };
+    
+    // Schroeder allpass on its own interleaved ring, inside the feedback loop
+    // so each repeat comes back a little more smeared than the last
+    struct Diffuser
+    {
+        std::vector<float> ring;
+        int mask = 0;
+        int length = 1;
+        int writeIndex = 0;
+    };
+    
+    // Delay storage: frame i sits at ring[2 * i] (left) and ring[2 * i + 1] (right)
+    std::vector<float> ring;
+    int bufferFrames = 0;
+    int bufferMask = 0;
+    int writeIndex = 0;
+    static constexpr float maxDelaySeconds = 4.0f;      // a whole note at 60 BPM
+    static constexpr float maxModulationMs = 3.0f;
+    static constexpr int minimumDelaySamples = 4;
+    
+    // Delay time glides towards its target so edits bend the pitch like tape
+    static constexpr double glideSeconds = 0.12;
+    double targetDelaySamples = 0.0;
+    double currentDelaySamples = 0.0;
+    double glideCoefficient = 0.0;
+    bool jumpToTarget = true;
+    FractionalDelay::Quality interpolationQuality = FractionalDelay::Quality::Cubic;
+    
+    // Wow/flutter: quadrature sine oscillator advanced by a rotation each frame
+    float lfoSin = 0.0f;
+    float lfoCos = 1.0f;
+    float lfoRotationSin = 0.0f;
+    float lfoRotationCos = 1.0f;
+    float modulationSamples = 0.0f;
+    
+    // Filtering for analog character: one-pole high cut and low cut on the repeats
+    float highCutCoefficient = 1.0f;
+    float lowCutCoefficient = 0.0f;
+    Frame highCutState;
+    Frame lowCutState;
     
     // Diffusion (all-pass filters for smearing)
-    juce::dsp::IIR::Filter<float> diffusionFilter1L, diffusionFilter1R;
-    juce::dsp::IIR::Filter<float> diffusionFilter2L, diffusionFilter2R;
+    Diffuser diffuser1, diffuser2;
+    float diffusionGain = 0.0f;
     
     // Processing state
     double currentSampleRate = 44100.0;
     int maxDelayInSamples = 0;
     bool isPrepared = false;
     
-    // Ping-pong delay state
-    float crossfeedL = 0.0f;
-    float crossfeedR = 0.0f;
+    void resetState();
+    static void prepareDiffuser(Diffuser& diffuser, int lengthFrames);
+    static Frame processDiffuser(Diffuser& diffuser, Frame input, float gain);
     
     // Parameter updates
     void updateDelayTime();
@@ -0,0 +1,313 @@
+#include "DelayEngine.h"
+
+DelayEngine::DelayEngine()
+{
+}
+
+DelayEngine::~DelayEngine()
+{
+}
+
+void DelayEngine::prepare(double sampleRate, int numChannels, float maxDelaySeconds)
+{
+    currentSampleRate = sampleRate;
+
+    bufferSize = juce::nextPowerOfTwo(static_cast<int>(sampleRate * maxDelaySeconds) + 1);
+    bufferMask = bufferSize - 1;
+
+    // The ring always holds both lanes; a mono chain leaves them identical
+    numPreparedChannels = juce::jlimit(1, numLanes, numChannels);
+    ring.assign(static_cast<size_t>(bufferSize) * numLanes, 0.0f);
+
+    // The per-sample fade step is fixed here so processing never divides
+    crossfadeLength = juce::jmax(1, static_cast<int>(sampleRate * crossfadeSeconds));
+    crossfadeStep = 1.0f / static_cast<float>(crossfadeLength);
+    glideCoefficient = 1.0 - std::exp(-1.0 / (glideSeconds * sampleRate));
+
+    isPrepared = true;
+    reset();
+}
+
+void DelayEngine::reset()
+{
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    dampingState.fill(0.0f);
+    writeIndex = 0;
+
+    // The ring is silent, so there is nothing to fade from
+    crossfadeRemaining = 0;
+    jumpToTarget = true;
+}
+
+void DelayEngine::process(float* const* channels, int numChannels, int numSamples)
+{
+    if (!isPrepared)
+        return;
+
+    numChannels = juce::jmin(numChannels, numPreparedChannels);
+    if (numChannels <= 0)
+        return;
+
+    int processed = 0;
+
+    while (processed < numSamples)
+    {
+        if (jumpToTarget)
+        {
+            delaySamples = targetDelaySamples;
+            glideDelay = targetDelaySamples;
+            jumpToTarget = false;
+        }
+
+        // New times wait for any running fade. A glide just retargets; a crossfade
+        // starts from wherever the read position currently is
+        if (crossfadeRemaining == 0 && targetDelaySamples != delaySamples)
+        {
+            if (targetChange == TimeChange::Crossfade)
+            {
+                previousDelaySamples = static_cast<int>(std::round(glideDelay));
+                glideDelay = targetDelaySamples;
+                crossfadeRemaining = crossfadeLength;
+            }
+
+            delaySamples = targetDelaySamples;
+        }
+
+        int length = 0;
+
+        if (crossfadeRemaining > 0)
+            length = processCrossfade(channels, numChannels, processed, numSamples - processed);
+        else if (glideDelay != static_cast<double>(delaySamples))
+            length = processGlide(channels, numChannels, processed, numSamples - processed);
+        else
+            length = processFixed(channels, numChannels, processed, numSamples - processed);
+
+        writeIndex = (writeIndex + length) & bufferMask;
+        processed += length;
+    }
+}
+
+int DelayEngine::processFixed(float* const* channels, int numChannels, int offset, int maxLength)
+{
+    // A span no longer than the delay only reads samples written before it
+    // started, and is cut again wherever the read or write position wraps
+    const int readIndex = (writeIndex - delaySamples) & bufferMask;
+    const int length = juce::jmin(juce::jmin(maxLength, delaySamples),
+                                  juce::jmin(bufferSize - readIndex, bufferSize - writeIndex));
+
+    float* data = ring.data();
+    processSpan(channels[0] + offset, channels[numChannels - 1] + offset,
+                data + numLanes * readIndex, data + numLanes * writeIndex, length);
+
+    return length;
+}
+
+int DelayEngine::processCrossfade(float* const* channels, int numChannels, int offset, int maxLength)
+{
+    // Both taps obey the fixed span rules, and the span ends where the fade does
+    const int readIndex = (writeIndex - delaySamples) & bufferMask;
+    const int previousIndex = (writeIndex - previousDelaySamples) & bufferMask;
+    const int length = juce::jmin(juce::jmin(juce::jmin(maxLength, crossfadeRemaining),
+                                             juce::jmin(delaySamples, previousDelaySamples)),
+                                  juce::jmin(juce::jmin(bufferSize - readIndex, bufferSize - previousIndex),
+                                             bufferSize - writeIndex));
+
+    const float fadeStart = static_cast<float>(crossfadeLength - crossfadeRemaining) * crossfadeStep;
+
+    float* data = ring.data();
+    processCrossfadeSpan(channels[0] + offset, channels[numChannels - 1] + offset, data + numLanes * readIndex,
+                         data + numLanes * previousIndex, data + numLanes * writeIndex, length, fadeStart);
+
+    crossfadeRemaining -= length;
+    return length;
+}
+
+int DelayEngine::processGlide(float* const* channels, int numChannels, int offset, int maxLength)
+{
+    // With at least minimumDelaySamples of delay every tap is older than the sample
+    // being written, so the span only has to stop where the write position wraps
+    const int length = juce::jmin(juce::jmin(maxLength, glideBlockSize), bufferSize - writeIndex);
+
+    // Read positions and weights are worked out once and shared by both lanes
+    const double target = static_cast<double>(delaySamples);
+    double delay = glideDelay;
+
+    for (int i = 0; i < length; ++i)
+    {
+        delay += glideCoefficient * (target - delay);
+
+        // Split before converting so the fraction keeps full precision on long delays
+        const int whole = static_cast<int>(delay);
+        const float fraction = static_cast<float>(delay - whole);
+
+        // Reading 'fraction' before sample (write - whole) is reading at
+        // (write - whole - 1) + (1 - fraction)
+        glideIndex[static_cast<size_t>(i)] = writeIndex + i - whole - 1;
+        glideWeights[static_cast<size_t>(i)] = FractionalDelay::computeWeights(interpolationQuality, 1.0f - fraction);
+    }
+
+    // Snap once the remaining distance is inaudible, handing back to the fixed path
+    glideDelay = (std::abs(target - delay) < glideSnapSamples) ? target : delay;
+
+    processGlideSpan(channels[0] + offset, channels[numChannels - 1] + offset,
+                     ring.data() + numLanes * writeIndex, length);
+
+    return length;
+}
+
+void DelayEngine::processSpan(float* left, float* right, const float* read, float* write, int numSamples)
+{
+    const float feedbackGain = feedback;
+    const float wetAmount = mix;
+
+    // Both inputs are read before either output is written, so a mono
+    // buffer passed as left and right comes out the same as one lane
+    if (dampingCoefficient <= 0.0f)
+    {
+        // No loop-carried state, so the lanes pair up and this vectorizes
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float inputL = left[i];
+            const float inputR = right[i];
+            const float lineL = inputL + feedbackGain * read[2 * i];
+            const float lineR = inputR + feedbackGain * read[2 * i + 1];
+            write[2 * i] = lineL;
+            write[2 * i + 1] = lineR;
+            left[i] = inputL + wetAmount * (lineL - inputL);
+            right[i] = inputR + wetAmount * (lineR - inputR);
+        }
+
+        return;
+    }
+
+    // One-pole lowpass on the repeats; the recursion runs along each lane,
+    // with the two lanes side by side
+    const float coefficient = dampingCoefficient;
+    float filteredL = dampingState[0];
+    float filteredR = dampingState[1];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float inputL = left[i];
+        const float inputR = right[i];
+        filteredL += coefficient * (read[2 * i] - filteredL);
+        filteredR += coefficient * (read[2 * i + 1] - filteredR);
+        const float lineL = inputL + feedbackGain * filteredL;
+        const float lineR = inputR + feedbackGain * filteredR;
+        write[2 * i] = lineL;
+        write[2 * i + 1] = lineR;
+        left[i] = inputL + wetAmount * (lineL - inputL);
+        right[i] = inputR + wetAmount * (lineR - inputR);
+    }
+
+    dampingState = { filteredL, filteredR };
+}
+
+void DelayEngine::processCrossfadeSpan(float* left, float* right, const float* read, const float* previousRead,
+                                       float* write, int numSamples, float fadeStart)
+{
+    const float feedbackGain = feedback;
+    const float wetAmount = mix;
+    const float step = crossfadeStep;
+
+    // Only runs for the length of a fade, so one loop covers both damping settings
+    const float coefficient = (dampingCoefficient > 0.0f) ? dampingCoefficient : 1.0f;
+    float filteredL = dampingState[0];
+    float filteredR = dampingState[1];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float inputL = left[i];
+        const float inputR = right[i];
+        const float fade = fadeStart + static_cast<float>(i) * step;
+        const float delayedL = previousRead[2 * i] + fade * (read[2 * i] - previousRead[2 * i]);
+        const float delayedR = previousRead[2 * i + 1] + fade * (read[2 * i + 1] - previousRead[2 * i + 1]);
+        filteredL += coefficient * (delayedL - filteredL);
+        filteredR += coefficient * (delayedR - filteredR);
+        const float lineL = inputL + feedbackGain * filteredL;
+        const float lineR = inputR + feedbackGain * filteredR;
+        write[2 * i] = lineL;
+        write[2 * i + 1] = lineR;
+        left[i] = inputL + wetAmount * (lineL - inputL);
+        right[i] = inputR + wetAmount * (lineR - inputR);
+    }
+
+    dampingState = { filteredL, filteredR };
+}
+
+void DelayEngine::processGlideSpan(float* left, float* right, float* write, int numSamples)
+{
+    const float feedbackGain = feedback;
+    const float wetAmount = mix;
+    const float coefficient = (dampingCoefficient > 0.0f) ? dampingCoefficient : 1.0f;
+    const float* data = ring.data();
+    const int mask = bufferMask;
+    float filteredL = dampingState[0];
+    float filteredR = dampingState[1];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto& w = glideWeights[static_cast<size_t>(i)];
+        const int index = glideIndex[static_cast<size_t>(i)];
+
+        // The four taps of both lanes are eight neighbouring floats unless the read wraps
+        const float* tap0 = data + numLanes * ((index - 1) & mask);
+        const float* tap1 = data + numLanes * (index & mask);
+        const float* tap2 = data + numLanes * ((index + 1) & mask);
+        const float* tap3 = data + numLanes * ((index + 2) & mask);
+
+        const float delayedL = w[0] * tap0[0] + w[1] * tap1[0] + w[2] * tap2[0] + w[3] * tap3[0];
+        const float delayedR = w[0] * tap0[1] + w[1] * tap1[1] + w[2] * tap2[1] + w[3] * tap3[1];
+
+        const float inputL = left[i];
+        const float inputR = right[i];
+        filteredL += coefficient * (delayedL - filteredL);
+        filteredR += coefficient * (delayedR - filteredR);
+        const float lineL = inputL + feedbackGain * filteredL;
+        const float lineR = inputR + feedbackGain * filteredR;
+        write[2 * i] = lineL;
+        write[2 * i + 1] = lineR;
+        left[i] = inputL + wetAmount * (lineL - inputL);
+        right[i] = inputR + wetAmount * (lineR - inputR);
+    }
+
+    dampingState = { filteredL, filteredR };
+}
+
+void DelayEngine::setDelayTime(float seconds, TimeChange change)
+{
+    const int samples = static_cast<int>(std::round(seconds * currentSampleRate));
+    targetDelaySamples = juce::jlimit(minimumDelaySamples, juce::jmax(minimumDelaySamples, bufferSize - 1), samples);
+    targetChange = change;
+}
+
+void DelayEngine::setInterpolationQuality(FractionalDelay::Quality quality)
+{
+    interpolationQuality = quality;
+}
+
+void DelayEngine::setFeedback(float newFeedback)
+{
+    feedback = juce::jlimit(0.0f, 0.95f, newFeedback);
+}
+
+void DelayEngine::setDamping(float amount)
+{
+    amount = juce::jlimit(0.0f, 1.0f, amount);
+
+    if (amount <= 0.0f)
+    {
+        dampingCoefficient = 0.0f;
+        return;
+    }
+
+    // Exponential sweep of the feedback lowpass from 20 kHz down to 1 kHz
+    const double cutoffHz = 20000.0 * std::pow(0.05, static_cast<double>(amount));
+    const double nyquistLimited = juce::jmin(cutoffHz, currentSampleRate * 0.45);
+    dampingCoefficient = static_cast<float>(1.0 - std::exp(-juce::MathConstants<double>::twoPi * nyquistLimited / currentSampleRate));
+}
+
+void DelayEngine::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
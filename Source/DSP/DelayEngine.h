@@ -0,0 +1,102 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "FractionalDelay.h"
+#include <array>
+#include <vector>
+
+/**
+ * Block-based feedback delay used by the DSP chain
+ * Works on contiguous spans of a power-of-two ring, with the feedback,
+ * damping and dry/wet mix fused into a single pass over each span. Left
+ * and right share one interleaved ring, so a long delay streams a single
+ * region of memory and each frame is processed as two lanes together.
+ * Delay time changes either glide the read position at audio rate, for
+ * tape-style pitch bends, or crossfade from the old tap to the new one, so
+ * tempo changes never bend the pitch
+ */
+class DelayEngine
+{
+public:
+    DelayEngine();
+    ~DelayEngine();
+
+    // Audio processing lifecycle
+    void prepare(double sampleRate, int numChannels, float maxDelaySeconds);
+    void reset();
+
+    // In-place processing of up to two channels; channels beyond the prepared
+    // count are left untouched. A mono buffer runs through both lanes alike
+    void process(float* const* channels, int numChannels, int numSamples);
+
+    // How a new delay time is reached
+    enum class TimeChange
+    {
+        Glide,      // read position slews towards the new time (tape style)
+        Crossfade   // old tap fades out as the new one fades in, no pitch change
+    };
+
+    // Parameter control (block rate)
+    void setDelayTime(float seconds, TimeChange change = TimeChange::Glide); // 4 samples .. maxDelaySeconds
+    void setInterpolationQuality(FractionalDelay::Quality quality);        // used while gliding
+    void setFeedback(float newFeedback);    // 0 to 0.95
+    void setDamping(float amount);          // 0 (off) to 1 (feedback lowpass at 1 kHz)
+    void setMix(float newMix);              // 0 to 1, mix of the line input against the dry signal
+
+private:
+    // Delay storage: frame i sits at ring[2 * i] (left) and ring[2 * i + 1]
+    // (right). Sizes and positions below count frames
+    static constexpr int numLanes = 2;
+    std::vector<float> ring;
+    int numPreparedChannels = 0;
+    int bufferSize = 0;
+    int bufferMask = 0;
+    int writeIndex = 0;
+    static constexpr int minimumDelaySamples = 4;
+    int delaySamples = minimumDelaySamples;
+
+    // Tap crossfade: the previous tap fades out over crossfadeLength samples
+    static constexpr double crossfadeSeconds = 0.05;
+    int targetDelaySamples = minimumDelaySamples;
+    int previousDelaySamples = minimumDelaySamples;
+    int crossfadeLength = 1;
+    int crossfadeRemaining = 0;
+    float crossfadeStep = 1.0f;
+    bool jumpToTarget = true;   // set by reset(): the first time after it applies without a fade
+    TimeChange targetChange = TimeChange::Glide;
+
+    // Glide: the fractional delay follows delaySamples with a one-pole slew.
+    // Positions and weights for one span are shared by all channels
+    static constexpr double glideSeconds = 0.12;
+    static constexpr double glideSnapSamples = 0.001;
+    static constexpr int glideBlockSize = 64;
+    double glideDelay = minimumDelaySamples;
+    double glideCoefficient = 0.0;
+    FractionalDelay::Quality interpolationQuality = FractionalDelay::Quality::Cubic;
+    std::array<int, glideBlockSize> glideIndex {};
+    std::array<FractionalDelay::Weights, glideBlockSize> glideWeights {};
+
+    // Parameters
+    float feedback = 0.3f;
+    float mix = 0.0f;
+    float dampingCoefficient = 0.0f;
+    std::array<float, numLanes> dampingState {};
+
+    // Processing state
+    double currentSampleRate = 44100.0;
+    bool isPrepared = false;
+
+    // Each returns the number of samples it consumed
+    int processFixed(float* const* channels, int numChannels, int offset, int maxLength);
+    int processCrossfade(float* const* channels, int numChannels, int offset, int maxLength);
+    int processGlide(float* const* channels, int numChannels, int offset, int maxLength);
+
+    // Spans take the two channel pointers (the same one twice for mono) and
+    // interleaved ring pointers
+    void processSpan(float* left, float* right, const float* read, float* write, int numSamples);
+    void processCrossfadeSpan(float* left, float* right, const float* read, const float* previousRead,
+                              float* write, int numSamples, float fadeStart);
+    void processGlideSpan(float* left, float* right, float* write, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayEngine)
+};
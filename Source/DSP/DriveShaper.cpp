@@ -0,0 +1,81 @@
+#include "DriveShaper.h"
+
+namespace
+{
+    constexpr float ceiling = 0.95f;
+    
+    // x + k x^3, clamped at the ceiling; k = 0 is a plain hard clip
+    void shapeCubic(float* const* channels, int numChannels, int numSamples, float cubic)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* samples = channels[channel];
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float x = samples[i];
+                samples[i] = std::min(std::max(x + cubic * x * x * x, -ceiling), ceiling);
+            }
+        }
+    }
+    
+    // Both curves on the same input, mixed by a weight stepping linearly
+    // from startMix to endMix across the block
+    void shapeCubicBlend(float* const* channels, int numChannels, int numSamples,
+                         float cubicA, float cubicB, float startMix, float endMix)
+    {
+        const float mixStep = (endMix - startMix) / static_cast<float>(numSamples);
+    
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* samples = channels[channel];
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float x = samples[i];
+                const float x3 = x * x * x;
+                const float a = std::min(std::max(x + cubicA * x3, -ceiling), ceiling);
+                const float b = std::min(std::max(x + cubicB * x3, -ceiling), ceiling);
+                const float mix = startMix + mixStep * static_cast<float>(i + 1);
+                samples[i] = a + mix * (b - a);
+            }
+        }
+    }
+}
+
+DriveShaper::DriveShaper()
+{
+}
+
+DriveShaper::~DriveShaper()
+{
+}
+
+float DriveShaper::getCubic(Curve c)
+{
+    switch (c)
+    {
+        case Curve::HardClip:
+            return 0.0f;
+        case Curve::Fuzz:
+            return 2.0f;
+        case Curve::SoftClip:
+        default:
+            return 0.5f;
+    }
+}
+
+void DriveShaper::processNonlinear(float* const* channels, int numChannels, int numSamples)
+{
+    const float cubic = getCubic(curve);
+    const float otherCubic = getCubic(crossfadeCurve);
+    const float startMix = previousCrossfade;
+    const float endMix = crossfade;
+    previousCrossfade = endMix;
+    
+    // A single curve unless a second one is, or was, mixed in
+    if (cubic == otherCubic || (startMix == 0.0f && endMix == 0.0f))
+        shapeCubic(channels, numChannels, numSamples, cubic);
+    else if (startMix == 1.0f && endMix == 1.0f)
+        shapeCubic(channels, numChannels, numSamples, otherCubic);
+    else
+        shapeCubicBlend(channels, numChannels, numSamples, cubic, otherCubic, startMix, endMix);
+}
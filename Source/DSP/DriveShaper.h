@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "NonlinearStage.h"
+
+/**
+ * The chain's drive waveshaper as a NonlinearStage
+ * Each curve is an inline clamped polynomial run as a flat loop per
+ * channel, with the curve chosen once per block rather than per sample.
+ * For preset morphing the shaper can blend its curve with a second one;
+ * both are memoryless, so the blend is two shapers on the same input with
+ * the mix ramped across each block instead of switching between them
+ */
+class DriveShaper : public NonlinearStage
+{
+public:
+    enum class Curve
+    {
+        SoftClip,
+        HardClip,
+        Fuzz
+    };
+    
+    DriveShaper();
+    ~DriveShaper() override;
+    
+    // Audio thread, between blocks
+    void setCurve(Curve newCurve) { curve = newCurve; }
+    void setActive(bool shouldBeActive) { active = shouldBeActive; }
+    
+    // Mixes in another curve, 0 to 1; the mix ramps there over the next block
+    void setCrossfade(Curve otherCurve, float amount)
+    {
+        crossfadeCurve = otherCurve;
+        crossfade = juce::jlimit(0.0f, 1.0f, amount);
+    }
+    
+    // NonlinearStage
+    bool isNonlinearActive() const override { return active; }
+    void processNonlinear(float* const* channels, int numChannels, int numSamples) override;
+    
+private:
+    Curve curve = Curve::SoftClip;
+    Curve crossfadeCurve = Curve::SoftClip;
+    float crossfade = 0.0f;
+    float previousCrossfade = 0.0f;
+    bool active = false;
+    
+    static float getCubic(Curve c);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DriveShaper)
+};
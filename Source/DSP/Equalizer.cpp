@@ -0,0 +1,430 @@
+#include "Equalizer.h"
+
+Equalizer::Equalizer()
+{
+}
+
+Equalizer::~Equalizer()
+{
+}
+
+void Equalizer::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    preparedChannels = juce::jlimit(1, 2, numChannels);
+    analogOversampler.prepare(sampleRate, samplesPerBlock, preparedChannels);
+    
+    for (auto& row : cascade)
+        row.reset();
+    
+    midDetector.reset();
+    midEnvelope = 0.0f;
+    midCutDb = 0.0f;
+    
+    updateLowShelf();
+    updateMidDynamics();
+    updateHighShelf();
+    updateTiltFilter();
+    updateAnalogModeling();
+    
+    isPrepared = true;
+}
+
+void Equalizer::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    if (!isPrepared || !enabled)
+        return;
+    
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), preparedChannels);
+    
+    if (numChannels == 0 || numSamples == 0)
+        return;
+    
+    // Only the sections that actually shape the sound run
+    std::array<SIMDBiquad<2>*, numSections> rows {};
+    int numRows = 0;
+    
+    for (int section = 0; section < numSections; ++section)
+        if (sectionActive[static_cast<size_t>(section)])
+            rows[static_cast<size_t>(numRows++)] = &cascade[static_cast<size_t>(section)];
+    
+    // Left and right advance through the cascade together. A dynamic mid band
+    // works in sub-blocks so its coefficients can follow the envelope
+    float* left = buffer.getWritePointer(0);
+    float* right = (numChannels > 1) ? buffer.getWritePointer(1) : left;
+    const int span = midDynamic ? dynamicSubBlock : numSamples;
+    
+    if (numRows > 0)
+    {
+        for (int start = 0; start < numSamples; start += span)
+        {
+            const int length = juce::jmin(span, numSamples - start);
+    
+            if (midDynamic)
+                updateDynamicMid(left + start, right + start, length);
+    
+            processSpan(left + start, right + start, length, rows.data(), numRows);
+        }
+    }
+    
+    midDynamicCut.store(midCutDb, std::memory_order_relaxed);
+    
+    if (analogModeling && !analogStageExternal)
+        applyAnalogCharacter(buffer);
+}
+
+void Equalizer::processSpan(float* left, float* right, int numSamples,
+                            SIMDBiquad<2>* const* rows, int numRows)
+{
+    // With a mono buffer right == left: the right lane is written first and
+    // the left result lands over it
+    alignas(8) std::array<float, 2> lanes;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        lanes = { left[i], right[i] };
+    
+        for (int row = 0; row < numRows; ++row)
+            rows[row]->processSample(lanes.data(), lanes.data());
+    
+        right[i] = lanes[1];
+        left[i] = lanes[0];
+    }
+}
+
+void Equalizer::updateDynamicMid(const float* left, const float* right, int numSamples)
+{
+    // Peak follower on the band-passed mono sum, attack or release picked with a select
+    const float attack = midAttackCoefficient;
+    const float release = midReleaseCoefficient;
+    float envelope = midEnvelope;
+    float band = 0.0f;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float mono = 0.5f * (left[i] + right[i]);
+        midDetector.processSample(&mono, &band);
+    
+        const float level = std::abs(band);
+        const float coefficient = (level > envelope) ? attack : release;
+        envelope = level + coefficient * (envelope - level);
+    }
+    
+    midEnvelope = envelope;
+    
+    // One dB conversion and gain-curve lookup per sub-block
+    const float levelDb = juce::Decibels::gainToDecibels(envelope, -120.0f);
+    midCutDb = juce::jmax(midGainComputer.computeGainDb(levelDb), -midDynamicRange);
+    
+    // Linear interpolation between neighbouring table designs. Every design
+    // is stable, and so is any blend of two of them
+    const float position = (midDynamicRange > 0.0f)
+                         ? (-midCutDb / midDynamicRange) * static_cast<float>(dynamicTableSize - 1) : 0.0f;
+    const int index = juce::jlimit(0, dynamicTableSize - 2, static_cast<int>(position));
+    const float fraction = juce::jlimit(0.0f, 1.0f, position - static_cast<float>(index));
+    
+    const auto& from = midCutTable[static_cast<size_t>(index)];
+    const auto& to = midCutTable[static_cast<size_t>(index + 1)];
+    const BiquadCoefficients blended { from.b0 + fraction * (to.b0 - from.b0), from.b1 + fraction * (to.b1 - from.b1),
+                                       from.b2 + fraction * (to.b2 - from.b2), from.a1 + fraction * (to.a1 - from.a1),
+                                       from.a2 + fraction * (to.a2 - from.a2) };
+    
+    auto& row = cascade[MidSection];
+    row.setLane(0, blended);
+    row.setLane(1, blended);
+}
+
+void Equalizer::releaseResources()
+{
+    isPrepared = false;
+}
+
+void Equalizer::setLowShelfFreq(float freqHz)
+{
+    lowShelfFreq = juce::jlimit(60.0f, 200.0f, freqHz);
+    updateLowShelf();
+}
+
+void Equalizer::setLowShelfGain(float gainDb)
+{
+    lowShelfGain = juce::jlimit(-12.0f, 12.0f, gainDb);
+    updateLowShelf();
+}
+
+void Equalizer::setMidFreq(float freqHz)
+{
+    midFreq = juce::jlimit(300.0f, 5000.0f, freqHz);
+    updateMidBand();
+}
+
+void Equalizer::setMidQ(float q)
+{
+    midQ = juce::jlimit(0.3f, 4.0f, q);
+    updateMidBand();
+}
+
+void Equalizer::setMidGain(float gainDb)
+{
+    midGain = juce::jlimit(-12.0f, 12.0f, gainDb);
+    updateMidBand();
+}
+
+void Equalizer::setHighShelfFreq(float freqHz)
+{
+    highShelfFreq = juce::jlimit(4000.0f, 10000.0f, freqHz);
+    updateHighShelf();
+}
+
+void Equalizer::setHighShelfGain(float gainDb)
+{
+    highShelfGain = juce::jlimit(-12.0f, 12.0f, gainDb);
+    updateHighShelf();
+}
+
+void Equalizer::setLowShelfQ(float q)
+{
+    lowShelfQ = juce::jlimit(0.3f, 2.0f, q);
+    updateLowShelf();
+}
+
+void Equalizer::setHighShelfQ(float q)
+{
+    highShelfQ = juce::jlimit(0.3f, 2.0f, q);
+    updateHighShelf();
+}
+
+void Equalizer::setTiltBalance(float tilt)
+{
+    tiltBalance = juce::jlimit(-1.0f, 1.0f, tilt);
+    updateTiltFilter();
+}
+
+void Equalizer::setAnalogModeling(bool shouldModel)
+{
+    analogModeling = shouldModel;
+    updateAnalogModeling();
+}
+
+void Equalizer::setAnalogOversampling(bool shouldOversample)
+{
+    if (shouldOversample != analogOversampling)
+        analogOversampler.reset();
+    
+    analogOversampling = shouldOversample;
+}
+
+void Equalizer::setMidDynamic(bool shouldBeDynamic)
+{
+    midDynamic = shouldBeDynamic;
+    updateMidDynamics();
+}
+
+void Equalizer::setMidDynamicThreshold(float thresholdDb)
+{
+    midDynamicThreshold = juce::jlimit(-60.0f, 0.0f, thresholdDb);
+    updateMidDynamics();
+}
+
+void Equalizer::setMidDynamicRatio(float ratio)
+{
+    midDynamicRatio = juce::jlimit(1.0f, 10.0f, ratio);
+    updateMidDynamics();
+}
+
+void Equalizer::setMidDynamicRange(float rangeDb)
+{
+    midDynamicRange = juce::jlimit(0.0f, 18.0f, rangeDb);
+    updateMidDynamics();
+}
+
+void Equalizer::applyParameters(const EqualizerParams& params)
+{
+    setEnabled(params.enabled);
+    setLowShelfFreq(params.lowShelfHz);
+    setLowShelfGain(params.lowGainDb);
+    setMidFreq(params.midHz);
+    setMidQ(params.midQ);
+    setMidGain(params.midGainDb);
+    setHighShelfFreq(params.highShelfHz);
+    setHighShelfGain(params.highGainDb);
+    setAnalogModeling(params.analogModeling);
+    setMidDynamic(params.midDynamic);
+    setMidDynamicThreshold(params.midDynamicThresholdDb);
+    setMidDynamicRange(params.midDynamicRangeDb);
+}
+
+void Equalizer::getFrequencyResponse(std::vector<float>& frequencies, std::vector<float>& magnitudes)
+{
+    const auto version = parameterVersion.load(std::memory_order_acquire);
+    
+    if (version != cachedVersion || cachedMagnitudes.empty())
+    {
+        // Designed here from the parameters rather than read from the cascade,
+        // so drawing costs the audio thread nothing
+        const double sampleRate = isPrepared ? currentSampleRate : 48000.0;
+    
+        std::array<BiquadCoefficients, numSections> designs;
+        for (int section = 0; section < numSections; ++section)
+            designs[static_cast<size_t>(section)] = designSection(static_cast<Section>(section), sampleRate);
+    
+        cachedFrequencies.resize(responsePoints);
+        cachedMagnitudes.resize(responsePoints);
+    
+        for (int point = 0; point < responsePoints; ++point)
+        {
+            // Log-spaced from 20 Hz to 20 kHz
+            const double frequency = 20.0 * std::pow(1000.0, point / static_cast<double>(responsePoints - 1));
+            const double omega = juce::MathConstants<double>::twoPi * juce::jmin(frequency, sampleRate * 0.5) / sampleRate;
+    
+            double magnitudeDb = 0.0;
+            for (const auto& design : designs)
+                magnitudeDb += design.magnitudeDb(omega);
+    
+            cachedFrequencies[static_cast<size_t>(point)] = static_cast<float>(frequency);
+            cachedMagnitudes[static_cast<size_t>(point)] = static_cast<float>(magnitudeDb);
+        }
+    
+        cachedVersion = version;
+    }
+    
+    frequencies = cachedFrequencies;
+    magnitudes = cachedMagnitudes;
+}
+
+BiquadCoefficients Equalizer::designSection(Section section, double sampleRate) const
+{
+    switch (section)
+    {
+        case LowShelfSection:
+            return BiquadCoefficients::lowShelf(sampleRate, lowShelfFreq, lowShelfQ, lowShelfGain);
+    
+        case MidSection:
+            return BiquadCoefficients::peaking(sampleRate, midFreq, midQ, midGain);
+    
+        case HighShelfSection:
+            return BiquadCoefficients::highShelf(sampleRate, highShelfFreq, highShelfQ, highShelfGain);
+    
+        case TiltSection:
+        {
+            // A broad high shelf around 650 Hz with the level pulled back by
+            // half its gain: the lows and highs move in opposite directions by up to 6 dB
+            const double gainDb = 12.0 * tiltBalance;
+            const auto compensation = static_cast<float>(juce::Decibels::decibelsToGain(-0.5 * gainDb));
+            return BiquadCoefficients::highShelf(sampleRate, 650.0, 0.5, gainDb).scaled(compensation);
+        }
+    
+        case AnalogSection:
+            // Gentle transformer-like rolloff at the top of the band
+            return analogModeling ? BiquadCoefficients::lowPass(sampleRate, 18000.0, 0.6) : BiquadCoefficients::identity();
+    
+        default:
+            return BiquadCoefficients::identity();
+    }
+}
+
+void Equalizer::setSection(Section section, const BiquadCoefficients& coefficients, bool active)
+{
+    auto& row = cascade[static_cast<size_t>(section)];
+    auto& isActive = sectionActive[static_cast<size_t>(section)];
+    
+    // A section coming back in starts from silence rather than stale state
+    if (active && !isActive)
+        row.reset();
+    
+    row.setLane(0, coefficients);
+    row.setLane(1, coefficients);
+    isActive = active;
+    
+    parameterVersion.fetch_add(1, std::memory_order_release);
+}
+
+void Equalizer::updateLowShelf()
+{
+    setSection(LowShelfSection, designSection(LowShelfSection, currentSampleRate), std::abs(lowShelfGain) > 0.01f);
+}
+
+void Equalizer::updateMidBand()
+{
+    midDetector.setLane(0, BiquadCoefficients::bandPass(currentSampleRate, midFreq, midQ));
+    
+    if (!midDynamic)
+    {
+        setSection(MidSection, designSection(MidSection, currentSampleRate), std::abs(midGain) > 0.01f);
+        return;
+    }
+    
+    // Designs from the static gain down to the full extra cut, in even steps
+    for (int i = 0; i < dynamicTableSize; ++i)
+    {
+        const double gainDb = midGain - midDynamicRange * i / static_cast<double>(dynamicTableSize - 1);
+        midCutTable[static_cast<size_t>(i)] = BiquadCoefficients::peaking(currentSampleRate, midFreq, midQ, gainDb);
+    }
+    
+    // Always in the cascade while dynamic; the first sub-block replaces these
+    setSection(MidSection, midCutTable[0], true);
+}
+
+void Equalizer::updateMidDynamics()
+{
+    midGainComputer.thresholdDb = midDynamicThreshold;
+    midGainComputer.ratio = midDynamicRatio;
+    midGainComputer.kneeDb = 6.0f;
+    
+    midAttackCoefficient = static_cast<float>(std::exp(-1.0 / (dynamicAttackMs * 0.001 * currentSampleRate)));
+    midReleaseCoefficient = static_cast<float>(std::exp(-1.0 / (dynamicReleaseMs * 0.001 * currentSampleRate)));
+    
+    if (!midDynamic)
+        midCutDb = 0.0f;
+    
+    updateMidBand();
+}
+
+void Equalizer::updateHighShelf()
+{
+    setSection(HighShelfSection, designSection(HighShelfSection, currentSampleRate), std::abs(highShelfGain) > 0.01f);
+}
+
+void Equalizer::updateTiltFilter()
+{
+    setSection(TiltSection, designSection(TiltSection, currentSampleRate), std::abs(tiltBalance) > 0.001f);
+}
+
+void Equalizer::updateAnalogModeling()
+{
+    setSection(AnalogSection, designSection(AnalogSection, currentSampleRate), analogModeling);
+}
+
+void Equalizer::processNonlinear(float* const* channels, int numChannels, int numSamples)
+{
+    // Cubic soft clip, y = x - 4x^3/27, which meets +-1 with zero slope at
+    // x = +-1.5; the input is clamped there so the curve never turns back.
+    // Third harmonic only, so at 2x nothing folds back below the base-rate
+    // Nyquist from content under a third of it. Memoryless and inline, so
+    // each channel is a flat loop the compiler vectorizes
+    constexpr float cubic = 4.0f / 27.0f;
+    constexpr float outputGain = 1.0f / analogDrive;
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* samples = channels[channel];
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = std::min(std::max(samples[i] * analogDrive, -1.5f), 1.5f);
+            samples[i] = (x - cubic * x * x * x) * outputGain;
+        }
+    }
+}
+
+void Equalizer::applyAnalogCharacter(juce::AudioBuffer<float>& buffer)
+{
+    if (analogOversampling)
+    {
+        NonlinearStage* stage = this;
+        analogOversampler.process(buffer, &stage, 1);
+        return;
+    }
+    
+    const int numChannels = juce::jmin(buffer.getNumChannels(), preparedChannels);
+    processNonlinear(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+}
@@ -1,17 +1,30 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
 #include "../Preset/PresetSchema.h"
+#include "GainComputer.h"
+#include "NonlinearStage.h"
+#include "OversamplingRegion.h"
+#include "SIMDBiquad.h"
+#include <array>
+#include <atomic>
+#include <vector>
 
 /**
  * Multi-band parametric equalizer
- * Supports traditional tone shaping and creative frequency manipulation
+ * Supports traditional tone shaping and creative frequency manipulation.
+ * All bands run as one biquad cascade with the left and right channels as
+ * the two lanes of each SIMDBiquad row, and flat bands are skipped. The UI
+ * curve is computed analytically from the same coefficient designs, away
+ * from the audio thread, and cached until a parameter changes. The analog
+ * saturator is a NonlinearStage, so it can run 2x oversampled on its own or
+ * inside an oversampling region shared with neighbouring stages
  */
-class Equalizer
+class Equalizer : public NonlinearStage
 {
 public:
     Equalizer();
-    ~Equalizer();
+    ~Equalizer() override;
     
     // Audio processing lifecycle
     void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels);
@@ -25,7 +38,7 @@ public:
     // Standard 3-band EQ parameters
     void setLowShelfFreq(float freqHz);     // 60 to 200 Hz
     void setLowShelfGain(float gainDb);     // -12 to 12 dB
-    void setMidFreq(float freqHz);          // 300 to 3000 Hz
+    void setMidFreq(float freqHz);          // 300 to 5000 Hz
     void setMidQ(float q);                  // 0.3 to 4
     void setMidGain(float gainDb);          // -12 to 12 dB
     void setHighShelfFreq(float freqHz);    // 4000 to 10000 Hz
@@ -37,10 +50,40 @@ public:
     void setTiltBalance(float tilt);        // -1 to 1 (tilt EQ)
     void setAnalogModeling(bool enabled);   // Analog saturation simulation
     
+    // Runs the analog saturator at twice the rate, adding getLatencyInSamples() of delay
+    void setAnalogOversampling(bool enabled);
+    
+    // The owning chain runs the saturator itself, through the NonlinearStage
+    // interface, and processBlock leaves it out
+    void setAnalogStageExternal(bool external) { analogStageExternal = external; }
+    
+    int getLatencyInSamples() const
+    {
+        return (analogOversampling && !analogStageExternal) ? OversamplingRegion::getLatencyInSamples() : 0;
+    }
+    
+    // NonlinearStage: the analog saturator alone
+    bool isNonlinearActive() const override { return enabled && analogModeling; }
+    void processNonlinear(float* const* channels, int numChannels, int numSamples) override;
+    
+    // Dynamic mid band: above the threshold the mid band cuts further, by up
+    // to the range, following an envelope of its own band (e.g. taming a
+    // harsh 2-4 kHz only when it flares up). The response curve shows the static band
+    void setMidDynamic(bool enabled);
+    void setMidDynamicThreshold(float thresholdDb); // -60 to 0 dB
+    void setMidDynamicRatio(float ratio);           // 1 to 10
+    void setMidDynamicRange(float rangeDb);         // 0 to 18 dB of extra cut
+    
+    // Extra cut applied by the dynamic mid band at the end of the last block, in dB
+    float getMidDynamicCut() const { return midDynamicCut.load(std::memory_order_relaxed); }
+    
     // Apply parameters from preset
     void applyParameters(const EqualizerParams& params);
     
-    // Frequency response analysis (for UI)
+    // Frequency response analysis (for UI): responsePoints log-spaced
+    // frequencies from 20 Hz to 20 kHz and the magnitude at each, in dB.
+    // Message thread only; recomputed only after a parameter change
+    static constexpr int responsePoints = 512;
     void getFrequencyResponse(std::vector<float>& frequencies, 
                             std::vector<float>& magnitudes);
     
@@ -58,39 +101,86 @@ private:
     float highShelfQ = 0.707f;
     float tiltBalance = 0.0f;
     bool analogModeling = true;
+    bool midDynamic = false;
+    float midDynamicThreshold = -30.0f;
+    float midDynamicRatio = 3.0f;
+    float midDynamicRange = 6.0f;
     
-    // DSP components
-    juce::dsp::IIR::Filter<float> lowShelfL, lowShelfR;
-    juce::dsp::IIR::Filter<float> midBandL, midBandR;
-    juce::dsp::IIR::Filter<float> highShelfL, highShelfR;
-    juce::dsp::IIR::Filter<float> tiltFilterL, tiltFilterR;
+    // Cascade sections, in processing order
+    enum Section
+    {
+        LowShelfSection,
+        MidSection,
+        HighShelfSection,
+        TiltSection,
+        AnalogSection,
+        numSections
+    };
     
-    // Analog modeling
-    juce::dsp::WaveShaper<float> analogSaturation;
-    juce::dsp::IIR::Filter<float> analogFilterL, analogFilterR;
+    // One row per section; lane 0 is the left channel and lane 1 the right.
+    // Sections designed flat are left out of the per-sample loop
+    std::array<SIMDBiquad<2>, numSections> cascade;
+    std::array<bool, numSections> sectionActive {};
+    
+    // Dynamic mid band. The detector band-passes the mono sum at the mid
+    // frequency and follows its peak. Once per sub-block the envelope sets
+    // the cut, and the mid section's coefficients are interpolated from a
+    // table designed across the cut range, so no filter is designed while
+    // processing
+    static constexpr int dynamicSubBlock = 32;
+    static constexpr int dynamicTableSize = 33;
+    static constexpr double dynamicAttackMs = 2.0;
+    static constexpr double dynamicReleaseMs = 80.0;
+    std::array<BiquadCoefficients, dynamicTableSize> midCutTable;
+    SIMDBiquad<1> midDetector;
+    GainComputer midGainComputer;
+    float midEnvelope = 0.0f;
+    float midAttackCoefficient = 0.0f;
+    float midReleaseCoefficient = 0.0f;
+    float midCutDb = 0.0f;
+    std::atomic<float> midDynamicCut{0.0f};
+    
+    // Analog modeling: gentle transformer-style saturation after the cascade,
+    // optionally through its own 2x oversampler
+    static constexpr float analogDrive = 1.2f;
+    bool analogOversampling = false;
+    bool analogStageExternal = false;
+    OversamplingRegion analogOversampler;
     
     // Processing state
     double currentSampleRate = 44100.0;
+    int preparedChannels = 0;
     bool isPrepared = false;
     
+    // Response cache. Every parameter change bumps the version; the UI
+    // rebuilds its curve only when the version it drew is stale
+    std::atomic<juce::uint32> parameterVersion{1};
+    juce::uint32 cachedVersion = 0;
+    std::vector<float> cachedFrequencies;
+    std::vector<float> cachedMagnitudes;
+    
     // Filter coefficient calculation
     void updateLowShelf();
     void updateMidBand();
     void updateHighShelf();
     void updateTiltFilter();
     void updateAnalogModeling();
+    void updateMidDynamics();
+    void setSection(Section section, const BiquadCoefficients& coefficients, bool active);
     
-    // Analog modeling functions
-    static float analogSaturationFunction(float sample);
-    void applyAnalogCharacter(juce::AudioBuffer<float>& buffer);
+    // Coefficient designs from the current parameters, shared by the audio
+    // path and the response curve
+    BiquadCoefficients designSection(Section section, double sampleRate) const;
+    
+    // Cascade over a span of samples; a mono buffer passes the same pointer twice
+    void processSpan(float* left, float* right, int numSamples,
+                     SIMDBiquad<2>* const* rows, int numRows);
     
-    // Utility functions
-    juce::dsp::IIR::Coefficients<float>::Ptr makeLowShelf(double sampleRate, 
-                                                          float freq, float q, float gain);
-    juce::dsp::IIR::Coefficients<float>::Ptr makeHighShelf(double sampleRate, 
-                                                           float freq, float q, float gain);
-    juce::dsp::IIR::Coefficients<float>::Ptr makePeakingFilter(double sampleRate, 
-                                                               float freq, float q, float gain);
+    // Runs the detector over one sub-block of input and sets the mid section for it
+    void updateDynamicMid(const float* left, const float* right, int numSamples);
+    
+    // Analog modeling
+    void applyAnalogCharacter(juce::AudioBuffer<float>& buffer);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Equalizer)
 };
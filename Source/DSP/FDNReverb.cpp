@@ -0,0 +1,425 @@
+#include "FDNReverb.h"
+
+// Line lengths span a 3-5x range so the modes spread evenly instead of clustering
+const FDNReverb::DelaySet FDNReverb::roomDelays  { 5.3f, 7.9f, 10.1f, 12.7f, 15.1f, 17.9f, 20.3f, 23.7f };
+const FDNReverb::DelaySet FDNReverb::plateDelays { 3.1f, 4.7f, 6.3f, 7.9f, 9.7f, 11.3f, 13.1f, 15.1f };
+const FDNReverb::DelaySet FDNReverb::hallDelays  { 23.9f, 29.3f, 34.1f, 39.7f, 45.1f, 52.3f, 59.9f, 68.7f };
+
+namespace
+{
+    // Entry (row, column) of the Sylvester-ordered Hadamard matrix
+    float hadamardSign(int row, int column)
+    {
+        int bits = row & column;
+        int parity = 0;
+
+        while (bits != 0)
+        {
+            parity ^= (bits & 1);
+            bits >>= 1;
+        }
+
+        return parity != 0 ? -1.0f : 1.0f;
+    }
+}
+
+FDNReverb::FDNReverb()
+{
+    alignas(32) float signsInL[numLines], signsInR[numLines];
+    alignas(32) float signsOutL[numLines], signsOutR[numLines];
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        signsInL[i] = hadamardSign(1, i);
+        signsInR[i] = hadamardSign(2, i);
+        signsOutL[i] = hadamardSign(3, i);
+        signsOutR[i] = hadamardSign(6, i);
+    }
+
+    for (int r = 0; r < numRegisters; ++r)
+    {
+        inputSignsL[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(signsInL + r * laneCount);
+        inputSignsR[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(signsInR + r * laneCount);
+        outputSignsL[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(signsOutL + r * laneCount);
+        outputSignsR[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(signsOutR + r * laneCount);
+        absorptionGain[static_cast<size_t>(r)] = SIMDFloat::expand(0.0f);
+        absorptionPole[static_cast<size_t>(r)] = SIMDFloat::expand(0.0f);
+        absorptionState[static_cast<size_t>(r)] = SIMDFloat::expand(0.0f);
+    }
+}
+
+FDNReverb::~FDNReverb()
+{
+}
+
+void FDNReverb::prepare(double sampleRate)
+{
+    currentSampleRate = sampleRate;
+
+    // Size every ring for the longest line of any algorithm so switching never allocates
+    float longestMs = 0.0f;
+    for (const auto* set : { &roomDelays, &plateDelays, &hallDelays })
+        for (auto ms : *set)
+            longestMs = juce::jmax(longestMs, ms);
+
+    const float headroomMs = maxModulationMs + 1.0f;
+    const int longestSamples = static_cast<int>(std::ceil((longestMs + headroomMs) * 0.001 * sampleRate));
+    bufferSize = juce::nextPowerOfTwo(longestSamples);
+    bufferMask = bufferSize - 1;
+    delayBuffer.assign(static_cast<size_t>(bufferSize * numLines), 0.0f);
+
+    shimmerShifterL.prepare(sampleRate);
+    shimmerShifterR.prepare(sampleRate);
+
+    isPrepared = true;
+
+    updateDelayLengths();
+    reset();
+}
+
+void FDNReverb::reset()
+{
+    std::fill(delayBuffer.begin(), delayBuffer.end(), 0.0f);
+    writeIndex = 0;
+
+    for (auto& state : absorptionState)
+        state = SIMDFloat::expand(0.0f);
+
+    modulationOffset.fill(0.0f);
+    modulationStep.fill(0.0f);
+    modulationTarget.fill(0.0f);
+    modulationRampRemaining = 0;
+    modulationDepthSamples = modulationDepthTarget;
+
+    shimmerShifterL.reset();
+    shimmerShifterR.reset();
+}
+
+void FDNReverb::process(float* left, float* right, int numSamples)
+{
+    if (!isPrepared)
+        return;
+
+    // Input is spread over the lines with orthogonal sign patterns; the output taps
+    // use two further Hadamard rows so L and R stay decorrelated
+    const float inputScale = 1.0f / std::sqrt(static_cast<float>(numLines));
+    const float outputScale = 1.0f / std::sqrt(static_cast<float>(numLines));
+    const float householderScale = -2.0f / static_cast<float>(numLines);
+
+    // Work on local copies of the recursive state; stores into the delay buffer
+    // would otherwise force the compiler to reload members every sample
+    auto state = absorptionState;
+    int write = writeIndex;
+
+    alignas(32) float taps[numLines];
+    std::array<SIMDFloat, numRegisters> lines;
+    float* buffer = delayBuffer.data();
+
+    // Modulated lines stay on the fractional path until their offsets have
+    // ramped back to zero, so a depth of 0 never snaps them onto integer taps
+    bool modulated = modulationDepthSamples > 0.0f;
+    for (auto offset : modulationOffset)
+        modulated = modulated || offset != 0.0f;
+
+    // A modulated line reads at its delay plus k + f, k whole and f in [0, 1],
+    // lerping from the tap at k towards the one at k + 1. The call runs in
+    // spans over which no line's k changes, so the further tap is the nearer
+    // one from the sample before: every line reads once per sample and the lerp
+    // runs on whole registers, skipping those with no modulated lines.
+    // Offsets ramp linearly, so f just advances by its step every sample
+    auto readDelay = delaySamples;
+    std::array<SIMDFloat, numRegisters> fractions {}, fractionSteps {}, furtherTaps {};
+
+    auto processSpan = [&](int spanStart, int spanEnd, auto modulatedTag)
+    {
+        constexpr bool isModulated = decltype(modulatedTag)::value;
+        auto spanFractions = fractions;
+        auto spanFurtherTaps = furtherTaps;
+        auto spanState = state;
+
+        for (int n = spanStart; n < spanEnd; ++n)
+        {
+            const float inL = left[n];
+            const float inR = (right != nullptr) ? right[n] : inL;
+
+            for (int i = 0; i < numLines; ++i)
+                taps[i] = buffer[i * bufferSize + ((write - readDelay[static_cast<size_t>(i)]) & bufferMask)];
+
+            auto wetL = SIMDFloat::expand(0.0f);
+            auto wetR = SIMDFloat::expand(0.0f);
+            auto total = SIMDFloat::expand(0.0f);
+
+            for (int r = 0; r < numRegisters; ++r)
+            {
+                const auto idx = static_cast<size_t>(r);
+
+                auto x = SIMDFloat::fromRawArray(taps + r * laneCount);
+
+                if (isModulated && r >= firstModulatedRegister)
+                {
+                    const auto nearer = x;
+                    x = nearer + spanFractions[idx] * (spanFurtherTaps[idx] - nearer);
+                    spanFurtherTaps[idx] = nearer;
+                    spanFractions[idx] += fractionSteps[idx];
+                }
+
+                // Per-line absorption: one-pole lowpass carrying the RT60 gain
+                auto y = absorptionGain[idx] * x + absorptionPole[idx] * spanState[idx];
+                spanState[idx] = y;
+                lines[idx] = y;
+
+                wetL += y * outputSignsL[idx];
+                wetR += y * outputSignsR[idx];
+                total += y;
+            }
+
+            const float sumL = wetL.sum();
+            const float sumR = wetR.sum();
+
+            // Householder feedback: y - (2/N) * sum(y), then inject the new input
+            const auto reflection = SIMDFloat::expand(total.sum() * householderScale);
+            const auto injectL = SIMDFloat::expand(inL * inputScale);
+            const auto injectR = SIMDFloat::expand(inR * inputScale);
+
+            if (shimmerAmount > 0.0f)
+            {
+                // Shimmer swaps part of the feedback components along the output rows
+                // for pitch shifted copies. The shifter's gain is <= 1, so the loop
+                // still decays at the RT60 rate while each pass climbs in pitch
+                const float componentL = sumL / static_cast<float>(numLines);
+                const float componentR = sumR / static_cast<float>(numLines);
+                const float shiftedL = shimmerShifterL.processSample(componentL);
+                const float shiftedR = shimmerShifterR.processSample(componentR);
+                const auto swapL = SIMDFloat::expand(shimmerAmount * (shiftedL - componentL));
+                const auto swapR = SIMDFloat::expand(shimmerAmount * (shiftedR - componentR));
+
+                for (int r = 0; r < numRegisters; ++r)
+                {
+                    const auto idx = static_cast<size_t>(r);
+                    lines[idx] += outputSignsL[idx] * swapL + outputSignsR[idx] * swapR;
+                }
+            }
+
+            for (int r = 0; r < numRegisters; ++r)
+            {
+                const auto idx = static_cast<size_t>(r);
+                auto feedback = lines[idx] + reflection + inputSignsL[idx] * injectL + inputSignsR[idx] * injectR;
+                feedback.copyToRawArray(taps + r * laneCount);
+            }
+
+            for (int i = 0; i < numLines; ++i)
+                buffer[i * bufferSize + write] = taps[i];
+
+            write = (write + 1) & bufferMask;
+
+            const float outL = sumL * outputScale;
+            const float outR = sumR * outputScale;
+
+            if (right != nullptr)
+            {
+                left[n] = outL;
+                right[n] = outR;
+            }
+            else
+            {
+                left[n] = 0.5f * (outL + outR);
+            }
+        }
+
+        state = spanState;
+    };
+
+    if (!modulated)
+    {
+        processSpan(0, numSamples, std::false_type{});
+    }
+    else
+    {
+        // The offsets ramp until the current ramp runs out and then hold
+        const int rampEnd = juce::jlimit(0, numSamples, modulationRampRemaining);
+        int spanStart = 0;
+
+        while (spanStart < numSamples)
+        {
+            const bool ramping = spanStart < rampEnd;
+            int spanEnd = ramping ? rampEnd : numSamples;
+
+            alignas(32) float fraction[numLines] {};
+            alignas(32) float fractionStep[numLines] {};
+            alignas(32) float further[numLines] {};
+
+            for (int m = 0; m < numModulatedLines; ++m)
+            {
+                const auto idx = static_cast<size_t>(m);
+                const int line = firstModulatedLine + m;
+                const float step = ramping ? modulationStep[idx] : 0.0f;
+                const float offset = modulationOffset[idx] + modulationStep[idx] * static_cast<float>(juce::jmin(spanStart, rampEnd));
+                const float whole = std::floor(offset);
+                const float f = offset - whole;
+
+                // End the span before f leaves [0, 1]
+                const float last = f + step * static_cast<float>(spanEnd - spanStart - 1);
+
+                if (last > 1.0f || last < 0.0f)
+                    spanEnd = spanStart + 1 + static_cast<int>(step > 0.0f ? (1.0f - f) / step : f / -step);
+
+                readDelay[static_cast<size_t>(line)] = delaySamples[static_cast<size_t>(line)] + static_cast<int>(whole);
+                fraction[line] = f;
+                fractionStep[line] = step;
+                further[line] = buffer[line * bufferSize + ((write - readDelay[static_cast<size_t>(line)] - 1) & bufferMask)];
+            }
+
+            for (int r = firstModulatedRegister; r < numRegisters; ++r)
+            {
+                fractions[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(fraction + r * laneCount);
+                fractionSteps[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(fractionStep + r * laneCount);
+                furtherTaps[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(further + r * laneCount);
+            }
+
+            processSpan(spanStart, spanEnd, std::true_type{});
+            spanStart = spanEnd;
+        }
+    }
+
+    absorptionState = state;
+    writeIndex = write;
+
+    // Advance the offsets over the call, landing exactly on the targets at
+    // the end of each ramp
+    for (size_t m = 0; m < modulationOffset.size(); ++m)
+    {
+        if (modulationRampRemaining <= numSamples)
+            modulationOffset[m] = modulationTarget[m];
+        else
+            modulationOffset[m] += modulationStep[m] * static_cast<float>(numSamples);
+    }
+
+    modulationRampRemaining = juce::jmax(0, modulationRampRemaining - numSamples);
+}
+
+void FDNReverb::setDelaySet(const DelaySet& delaysMs)
+{
+    delaySetMs = delaysMs;
+
+    if (isPrepared)
+        updateDelayLengths();
+}
+
+void FDNReverb::setDecayTime(float newRt60Seconds)
+{
+    rt60Seconds = juce::jlimit(0.05f, 30.0f, newRt60Seconds);
+
+    if (isPrepared)
+        updateAbsorption();
+}
+
+void FDNReverb::setHighFrequencyRatio(float ratio)
+{
+    highFrequencyRatio = juce::jlimit(0.05f, 1.0f, ratio);
+
+    if (isPrepared)
+        updateAbsorption();
+}
+
+void FDNReverb::setShimmer(float semitones, float amount)
+{
+    shimmerShifterL.setPitch(semitones);
+    shimmerShifterR.setPitch(semitones);
+    shimmerAmount = juce::jlimit(0.0f, 1.0f, amount);
+}
+
+void FDNReverb::setModulationDepth(float depthSamples)
+{
+    const float maxDepth = static_cast<float>(maxModulationMs * 0.001 * currentSampleRate);
+    modulationDepthTarget = juce::jlimit(0.0f, maxDepth, depthSamples);
+}
+
+void FDNReverb::setModulationTarget(float lfoLeft, float lfoRight, int rampSamples)
+{
+    rampSamples = juce::jmax(1, rampSamples);
+
+    // The depth glides to its target, taking depthRampSeconds for the full
+    // range, so offsets never jump when the depth changes
+    const float maxDepth = static_cast<float>(maxModulationMs * 0.001 * currentSampleRate);
+    const float maxDepthChange = maxDepth * static_cast<float>(rampSamples / (depthRampSeconds * currentSampleRate));
+    modulationDepthSamples += juce::jlimit(-maxDepthChange, maxDepthChange, modulationDepthTarget - modulationDepthSamples);
+
+    // Lines 4 and 5 follow the left LFO, 6 and 7 the right, with alternating
+    // polarity so the average delay (and so the pitch) of the tail stays put
+    const std::array<float, numModulatedLines> targets { lfoLeft, -lfoLeft, lfoRight, -lfoRight };
+    const float rampScale = 1.0f / static_cast<float>(rampSamples);
+
+    for (size_t m = 0; m < targets.size(); ++m)
+    {
+        modulationTarget[m] = targets[m] * modulationDepthSamples;
+        modulationStep[m] = (modulationTarget[m] - modulationOffset[m]) * rampScale;
+    }
+
+    modulationRampRemaining = rampSamples;
+}
+
+void FDNReverb::updateDelayLengths()
+{
+    int previous = 0;
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        // Distinct primes keep the line lengths mutually prime at any sample rate
+        int length = static_cast<int>(std::round(delaySetMs[static_cast<size_t>(i)] * 0.001 * currentSampleRate));
+        length = nextPrime(juce::jmax(length, previous + 1));
+        length = juce::jmin(length, bufferSize - 1);
+
+        delaySamples[static_cast<size_t>(i)] = length;
+        previous = length;
+    }
+
+    updateAbsorption();
+}
+
+void FDNReverb::updateAbsorption()
+{
+    alignas(32) float gains[numLines], poles[numLines];
+
+    const double broadbandSamples = rt60Seconds * currentSampleRate;
+    const double trebleSamples = broadbandSamples * highFrequencyRatio;
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        // A line of d samples must lose d/(RT60*fs) of 60 dB on every pass
+        const double d = delaySamples[static_cast<size_t>(i)];
+        const double dcGain = std::pow(10.0, -3.0 * d / broadbandSamples);
+        const double nyquistGain = std::pow(10.0, -3.0 * d / trebleSamples);
+
+        // One-pole b / (1 - p z^-1) with gain dcGain at DC and nyquistGain at fs/2
+        const double pole = (dcGain - nyquistGain) / (dcGain + nyquistGain);
+
+        poles[i] = static_cast<float>(pole);
+        gains[i] = static_cast<float>(dcGain * (1.0 - pole));
+    }
+
+    for (int r = 0; r < numRegisters; ++r)
+    {
+        absorptionGain[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(gains + r * laneCount);
+        absorptionPole[static_cast<size_t>(r)] = SIMDFloat::fromRawArray(poles + r * laneCount);
+    }
+}
+
+int FDNReverb::nextPrime(int value)
+{
+    auto isPrime = [](int n)
+    {
+        if (n < 2)
+            return false;
+
+        for (int divisor = 2; divisor * divisor <= n; ++divisor)
+            if (n % divisor == 0)
+                return false;
+
+        return true;
+    };
+
+    while (!isPrime(value))
+        ++value;
+
+    return value;
+}
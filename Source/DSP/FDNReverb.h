@@ -0,0 +1,109 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "PitchShifter.h"
+#include <array>
+#include <vector>
+
+/**
+ * Feedback delay network reverb engine
+ * Eight delay lines mixed through a Householder matrix, with per-line
+ * absorption filters tuned so the tail decays at the requested RT60
+ */
+class FDNReverb
+{
+public:
+    static constexpr int numLines = 8;
+
+    // Delay line lengths in milliseconds, rounded to distinct primes at prepare time
+    using DelaySet = std::array<float, numLines>;
+
+    FDNReverb();
+    ~FDNReverb();
+
+    // Audio processing lifecycle
+    void prepare(double sampleRate);
+    void reset();
+
+    // Stereo in-place processing, output is 100% wet. Pass nullptr for right on mono buffers
+    void process(float* left, float* right, int numSamples);
+
+    // Parameter control
+    void setDelaySet(const DelaySet& delaysMs);
+    void setDecayTime(float rt60Seconds);   // time for the tail to fall by 60 dB
+    void setHighFrequencyRatio(float ratio); // HF RT60 relative to the broadband RT60 (0.05 to 1)
+
+    // Pitch shift part of the feedback path (0 amount disables)
+    void setShimmer(float semitones, float amount);
+
+    // Delay modulation on half the lines. Targets are control-rate LFO values
+    // (-1 to 1) that the offsets ramp to linearly over rampSamples, holding
+    // there if the ramp runs out. Depth changes glide over depthRampSeconds
+    // for the full range
+    void setModulationDepth(float depthSamples);    // 0 to maxModulationMs
+    void setModulationTarget(float lfoLeft, float lfoRight, int rampSamples);
+
+    static constexpr float maxModulationMs = 1.0f;
+    static constexpr double depthRampSeconds = 0.2;
+
+    // Tuned line sets for each algorithm
+    static const DelaySet roomDelays;
+    static const DelaySet plateDelays;
+    static const DelaySet hallDelays;
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int laneCount = static_cast<int>(SIMDFloat::SIMDNumElements);
+    static constexpr int numRegisters = numLines / laneCount;
+    static_assert(numLines % laneCount == 0, "FDN line count must fill whole SIMD registers");
+
+    // The upper half of the lines is modulated, so the fractional reads fill
+    // whole registers and the lower half keeps plain integer reads
+    static constexpr int numModulatedLines = numLines / 2;
+    static constexpr int firstModulatedLine = numLines - numModulatedLines;
+    static constexpr int firstModulatedRegister = firstModulatedLine / laneCount;
+
+    // Parameters
+    DelaySet delaySetMs = hallDelays;
+    float rt60Seconds = 4.5f;
+    float highFrequencyRatio = 0.5f;
+
+    // Delay storage: numLines rings of bufferSize samples each, laid out back to back
+    std::vector<float> delayBuffer;
+    int bufferSize = 0;
+    int bufferMask = 0;
+    int writeIndex = 0;
+    std::array<int, numLines> delaySamples {};
+
+    // Per-line absorption filter (one-pole lowpass with DC gain = RT60 gain) and state
+    std::array<SIMDFloat, numRegisters> absorptionGain;
+    std::array<SIMDFloat, numRegisters> absorptionPole;
+    std::array<SIMDFloat, numRegisters> absorptionState;
+
+    // Input and output routing signs (rows of an 8x8 Hadamard matrix)
+    std::array<SIMDFloat, numRegisters> inputSignsL, inputSignsR;
+    std::array<SIMDFloat, numRegisters> outputSignsL, outputSignsR;
+
+    // Modulation offsets in samples for lines 4 to 7, ramped towards the LFO targets
+    float modulationDepthSamples = 0.0f;
+    float modulationDepthTarget = 0.0f;
+    std::array<float, numModulatedLines> modulationOffset {};
+    std::array<float, numModulatedLines> modulationStep {};
+    std::array<float, numModulatedLines> modulationTarget {};
+    int modulationRampRemaining = 0;
+
+    // Shimmer: shifters on the feedback components that feed the output taps
+    PitchShifter shimmerShifterL, shimmerShifterR;
+    float shimmerAmount = 0.0f;
+
+    // Processing state
+    double currentSampleRate = 44100.0;
+    bool isPrepared = false;
+
+    void updateDelayLengths();
+    void updateAbsorption();
+
+    static int nextPrime(int value);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FDNReverb)
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+
+/**
+ * Fractional-delay interpolation weights for reading between ring buffer samples
+ * All tiers use the four taps index - 1 .. index + 2 around a read position of
+ * index + fraction; Linear leaves the outer two at zero
+ */
+struct FractionalDelay
+{
+    enum class Quality
+    {
+        Linear,     // 2 taps, cheapest, dulls the top end while the delay moves
+        Cubic,      // 4-tap Hermite (Catmull-Rom), flat passband for its cost
+        Lagrange    // 4-tap third-order Lagrange, lowest error near DC
+    };
+
+    static constexpr int numTaps = 4;
+    using Weights = std::array<float, numTaps>;
+
+    static Weights computeWeights(Quality quality, float t) noexcept
+    {
+        switch (quality)
+        {
+            case Quality::Linear:
+                return { 0.0f, 1.0f - t, t, 0.0f };
+
+            case Quality::Cubic:
+            {
+                const float t2 = t * t;
+                const float t3 = t2 * t;
+                return { -0.5f * t + t2 - 0.5f * t3,
+                         1.0f - 2.5f * t2 + 1.5f * t3,
+                         0.5f * t + 2.0f * t2 - 1.5f * t3,
+                         -0.5f * t2 + 0.5f * t3 };
+            }
+
+            case Quality::Lagrange:
+            default:
+            {
+                // Nodes at -1, 0, 1, 2
+                const float a = t + 1.0f;
+                const float b = t - 1.0f;
+                const float c = t - 2.0f;
+                return { -t * b * c * (1.0f / 6.0f),
+                         a * b * c * 0.5f,
+                         -a * t * c * 0.5f,
+                         a * t * b * (1.0f / 6.0f) };
+            }
+        }
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+
+/**
+ * Feed-forward gain computer for the dynamics processors, working in dB
+ * The soft knee is the usual quadratic blend from unity gain into the ratio
+ * slope, written with clamps instead of branches so a block of levels can be
+ * processed in one vectorized pass
+ */
+struct GainComputer
+{
+    float thresholdDb = -18.0f;
+    float ratio = 3.0f;             // 1 or more
+    float kneeDb = 6.0f;            // total knee width, 0 for a hard knee
+
+    // Gain change in dB (zero or negative) for a detector level in dB
+    float computeGainDb(float levelDb) const noexcept
+    {
+        return computeGainDb(levelDb, thresholdDb, 1.0f / ratio - 1.0f, std::max(kneeDb, 1.0e-3f));
+    }
+
+    // Detector levels in, gain changes out; gainsDb may be the same array as levelsDb
+    void process(const float* levelsDb, float* gainsDb, int numSamples) const noexcept
+    {
+        const float threshold = thresholdDb;
+        const float slope = 1.0f / ratio - 1.0f;
+        const float width = std::max(kneeDb, 1.0e-3f);
+
+        for (int i = 0; i < numSamples; ++i)
+            gainsDb[i] = computeGainDb(levelsDb[i], threshold, slope, width);
+    }
+
+private:
+    static float computeGainDb(float levelDb, float threshold, float slope, float width) noexcept
+    {
+        // Below the knee both terms are zero; inside it only the quadratic term
+        // grows; above it the two sum to exactly (level - threshold)
+        const float over = levelDb - threshold;
+        const float inKnee = std::min(std::max(over + 0.5f * width, 0.0f), width);
+        const float aboveKnee = std::max(over - 0.5f * width, 0.0f);
+        return slope * (inKnee * inKnee / (2.0f * width) + aboveKnee);
+    }
+};
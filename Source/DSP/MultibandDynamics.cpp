@@ -0,0 +1,334 @@
+#include "MultibandDynamics.h"
+#include "../Utils/FastMath.h"
+
+MultibandDynamics::MultibandDynamics()
+{
+}
+
+MultibandDynamics::~MultibandDynamics()
+{
+}
+
+void MultibandDynamics::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    // Standalone use: the stage keeps its own arena
+    ownArena.reset();
+    prepareToPlay(sampleRate, samplesPerBlock, numChannels, ownArena);
+}
+
+void MultibandDynamics::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels, ScratchArena& arena)
+{
+    currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    preparedChannels = juce::jlimit(1, maxChannels, numChannels);
+    
+    // Band signals for every channel and slot, plus per-slot levels and gains
+    const auto blockFloats = static_cast<size_t>(maxBlockSize);
+    
+    for (auto& channelBands : bandScratch)
+        for (auto& band : channelBands)
+            band = arena.allocate(blockFloats);
+    
+    for (int slot = 0; slot < maxBands; ++slot)
+    {
+        levelScratch[static_cast<size_t>(slot)] = arena.allocate(blockFloats);
+        gainScratch[static_cast<size_t>(slot)] = arena.allocate(blockFloats);
+    }
+    
+    for (auto& row : halfSplit)
+        row.reset();
+    for (auto& row : slotSplit)
+        row.reset();
+    for (auto& slot : slots)
+        slot.envelopeDb = 0.0f;
+    
+    updateCrossovers();
+    
+    isPrepared = true;
+}
+
+void MultibandDynamics::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    if (!isPrepared || !enabled)
+        return;
+    
+    const int numSamples = buffer.getNumSamples();
+    
+    if (buffer.getNumChannels() == 0 || numSamples == 0)
+        return;
+    
+    // Hosts may send more than they announced; run those in prepared-size chunks
+    std::array<float, maxBands> deepestDb {};
+    
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+        processChunk(buffer, offset, juce::jmin(maxBlockSize, numSamples - offset), deepestDb);
+    
+    for (int slot = 0; slot < maxBands; ++slot)
+    {
+        const int band = slotBand[static_cast<size_t>(slot)];
+        if (band >= 0)
+            bandGainReduction[static_cast<size_t>(band)].store(-deepestDb[static_cast<size_t>(slot)], std::memory_order_relaxed);
+    }
+}
+
+void MultibandDynamics::processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples,
+                                     std::array<float, maxBands>& deepestDb)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), preparedChannels);
+    
+    splitBands(buffer, offset, numSamples, numChannels);
+    
+    for (int slot = 0; slot < maxBands; ++slot)
+    {
+        if (slotBand[static_cast<size_t>(slot)] >= 0)
+            computeSlotGains(slot, numSamples, numChannels, deepestDb[static_cast<size_t>(slot)]);
+        else
+            juce::FloatVectorOperations::clear(gainScratch[static_cast<size_t>(slot)], numSamples);
+    }
+    
+    // Weight and sum every slot in one pass. Silent slots hold zeros with a
+    // zero gain, so the loop never needs to know how many bands are in use
+    const float* g0 = gainScratch[0];
+    const float* g1 = gainScratch[1];
+    const float* g2 = gainScratch[2];
+    const float* g3 = gainScratch[3];
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto& bands = bandScratch[static_cast<size_t>(channel)];
+        const float* b0 = bands[0];
+        const float* b1 = bands[1];
+        const float* b2 = bands[2];
+        const float* b3 = bands[3];
+        float* output = buffer.getWritePointer(channel, offset);
+    
+        for (int i = 0; i < numSamples; ++i)
+            output[i] = b0[i] * g0[i] + b1[i] * g1[i] + b2[i] * g2[i] + b3[i] * g3[i];
+    }
+}
+
+void MultibandDynamics::splitBands(const juce::AudioBuffer<float>& buffer, int offset, int numSamples, int numChannels)
+{
+    // A mono input runs through the second channel's lanes too; those results are ignored
+    const float* left = buffer.getReadPointer(0, offset);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0, offset);
+    
+    std::array<float*, maxBands * maxChannels> outputs {};
+    for (int channel = 0; channel < maxChannels; ++channel)
+        for (int slot = 0; slot < maxBands; ++slot)
+            outputs[static_cast<size_t>(channel * maxBands + slot)] = bandScratch[static_cast<size_t>(channel)][static_cast<size_t>(slot)];
+    
+    // The filters are recursive in time, so this loop walks samples and
+    // vectorizes across lanes instead: every row is one pass over its lanes
+    alignas(32) std::array<float, 2 * maxChannels> halves;
+    alignas(32) std::array<float, maxBands * maxChannels> bands;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        halves = { left[i], left[i], right[i], right[i] };
+    
+        for (auto& row : halfSplit)
+            row.processSample(halves.data(), halves.data());
+    
+        bands = { halves[0], halves[0], halves[1], halves[1],
+                  halves[2], halves[2], halves[3], halves[3] };
+    
+        for (auto& row : slotSplit)
+            row.processSample(bands.data(), bands.data());
+    
+        for (size_t lane = 0; lane < bands.size(); ++lane)
+            outputs[lane][i] = bands[lane];
+    }
+}
+
+void MultibandDynamics::computeSlotGains(int slot, int numSamples, int numChannels, float& deepestDb)
+{
+    auto& dynamics = slots[static_cast<size_t>(slot)];
+    float* levels = levelScratch[static_cast<size_t>(slot)];
+    float* gains = gainScratch[static_cast<size_t>(slot)];
+    
+    // Stereo-linked peak of this band, in dB
+    const float* first = bandScratch[0][static_cast<size_t>(slot)];
+    for (int i = 0; i < numSamples; ++i)
+        levels[i] = std::abs(first[i]);
+    
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        const float* input = bandScratch[static_cast<size_t>(channel)][static_cast<size_t>(slot)];
+        for (int i = 0; i < numSamples; ++i)
+            levels[i] = juce::jmax(levels[i], std::abs(input[i]));
+    }
+    
+    FastMath::gainToDecibels(levels, levels, numSamples);
+    dynamics.computer.process(levels, gains, numSamples);
+    
+    // Downward expansion below the gate threshold, clamped rather than branched
+    if (dynamics.gateThresholdDb > -90.0f)
+    {
+        const float gateThreshold = dynamics.gateThresholdDb;
+    
+        for (int i = 0; i < numSamples; ++i)
+            gains[i] += std::max(std::min(levels[i] - gateThreshold, 0.0f) * expanderSlope, -expanderRangeDb);
+    }
+    
+    // Attack/release smoothing in dB with a select, as in the Compressor,
+    // with the band's makeup folded in on the way out
+    const float attack = dynamics.attackCoefficient;
+    const float release = dynamics.releaseCoefficient;
+    const float makeup = dynamics.makeupDb;
+    float envelope = dynamics.envelopeDb;
+    float deepest = deepestDb;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float target = gains[i];
+        const float coefficient = (target < envelope) ? attack : release;
+        envelope = target + coefficient * (envelope - target);
+        deepest = std::min(deepest, envelope);
+        gains[i] = envelope + makeup;
+    }
+    
+    dynamics.envelopeDb = envelope;
+    deepestDb = deepest;
+    
+    FastMath::decibelsToGain(gains, gains, numSamples);
+}
+
+void MultibandDynamics::releaseResources()
+{
+    // The storage belongs to whichever arena it came from
+    for (auto& channelBands : bandScratch)
+        channelBands.fill(nullptr);
+    
+    levelScratch.fill(nullptr);
+    gainScratch.fill(nullptr);
+    ownArena.reset();
+    isPrepared = false;
+}
+
+void MultibandDynamics::setNumBands(int newNumBands)
+{
+    numBands = juce::jlimit(2, maxBands, newNumBands);
+    updateCrossovers();
+}
+
+void MultibandDynamics::setCrossover(int index, float frequencyHz)
+{
+    if (index < 0 || index >= static_cast<int>(crossoverHz.size()))
+        return;
+    
+    crossoverHz[static_cast<size_t>(index)] = juce::jlimit(40.0f, 16000.0f, frequencyHz);
+    updateCrossovers();
+}
+
+void MultibandDynamics::setBand(int band, const MultibandDynamicsParams::Band& newBand)
+{
+    if (band < 0 || band >= maxBands)
+        return;
+    
+    auto& params = bandParams[static_cast<size_t>(band)];
+    params.thresholdDb = juce::jlimit(-60.0f, 0.0f, newBand.thresholdDb);
+    params.ratio = juce::jlimit(1.0f, 10.0f, newBand.ratio);
+    params.attackMs = juce::jlimit(0.1f, 50.0f, newBand.attackMs);
+    params.releaseMs = juce::jlimit(10.0f, 500.0f, newBand.releaseMs);
+    params.makeupDb = juce::jlimit(-12.0f, 12.0f, newBand.makeupDb);
+    params.gateThresholdDb = juce::jlimit(-90.0f, -20.0f, newBand.gateThresholdDb);
+    
+    for (int slot = 0; slot < maxBands; ++slot)
+        if (slotBand[static_cast<size_t>(slot)] == band)
+            updateSlot(slot);
+}
+
+void MultibandDynamics::applyParameters(const MultibandDynamicsParams& params)
+{
+    setEnabled(params.enabled);
+    
+    for (int band = 0; band < maxBands; ++band)
+        setBand(band, params.bands[static_cast<size_t>(band)]);
+    
+    for (int index = 0; index < static_cast<int>(crossoverHz.size()); ++index)
+        crossoverHz[static_cast<size_t>(index)] = juce::jlimit(40.0f, 16000.0f, params.crossoverHz[static_cast<size_t>(index)]);
+    
+    setNumBands(params.numBands);
+}
+
+void MultibandDynamics::updateCrossovers()
+{
+    // Crossovers in use, in ascending order; unused ones sort to the end
+    std::array<float, 3> f = crossoverHz;
+    for (size_t i = static_cast<size_t>(numBands - 1); i < f.size(); ++i)
+        f[i] = 16000.0f;
+    std::sort(f.begin(), f.end());
+    
+    // LR4 is two Butterworth sections; its LP + HP sum is the matching allpass
+    const double sr = currentSampleRate;
+    const double q = juce::MathConstants<double>::sqrt2 * 0.5;
+    const auto lowPass = [sr, q](float hz) { return BiquadCoefficients::lowPass(sr, hz, q); };
+    const auto highPass = [sr, q](float hz) { return BiquadCoefficients::highPass(sr, hz, q); };
+    const auto allPass = [sr, q](float hz) { return BiquadCoefficients::allPass(sr, hz, q); };
+    const auto identity = BiquadCoefficients::identity();
+    const auto silence = BiquadCoefficients::silence();
+    
+    // First level: split into halves. Each half then gets the allpass of the
+    // split made inside the other half, so both carry the same phase
+    const float halfFrequency = (numBands == 4) ? f[1] : f[0];
+    const auto lowAllPass = (numBands == 4) ? allPass(f[2]) : (numBands == 3) ? allPass(f[1]) : identity;
+    const auto highAllPass = (numBands == 4) ? allPass(f[0]) : identity;
+    
+    // Second level: the low half splits only with four bands, the high half with three or more
+    const bool splitLow = numBands == 4;
+    const bool splitHigh = numBands >= 3;
+    const float lowFrequency = f[0];
+    const float highFrequency = (numBands == 4) ? f[2] : f[1];
+    
+    for (int channel = 0; channel < maxChannels; ++channel)
+    {
+        const int low = 2 * channel;
+        const int firstSlot = maxBands * channel;
+    
+        for (size_t section = 0; section < 2; ++section)
+        {
+            halfSplit[section].setLane(low, lowPass(halfFrequency));
+            halfSplit[section].setLane(low + 1, highPass(halfFrequency));
+    
+            slotSplit[section].setLane(firstSlot, splitLow ? lowPass(lowFrequency) : identity);
+            slotSplit[section].setLane(firstSlot + 1, splitLow ? highPass(lowFrequency) : silence);
+            slotSplit[section].setLane(firstSlot + 2, splitHigh ? lowPass(highFrequency) : identity);
+            slotSplit[section].setLane(firstSlot + 3, splitHigh ? highPass(highFrequency) : silence);
+        }
+    
+        halfSplit[2].setLane(low, lowAllPass);
+        halfSplit[2].setLane(low + 1, highAllPass);
+    }
+    
+    // Slots 0-1 come from the low half and 2-3 from the high half
+    if (numBands == 4)
+        slotBand = { 0, 1, 2, 3 };
+    else if (numBands == 3)
+        slotBand = { 0, -1, 1, 2 };
+    else
+        slotBand = { 0, -1, 1, -1 };
+    
+    for (int slot = 0; slot < maxBands; ++slot)
+        updateSlot(slot);
+}
+
+void MultibandDynamics::updateSlot(int slot)
+{
+    const int band = slotBand[static_cast<size_t>(slot)];
+    if (band < 0)
+        return;
+    
+    const auto& params = bandParams[static_cast<size_t>(band)];
+    auto& dynamics = slots[static_cast<size_t>(slot)];
+    
+    dynamics.computer.thresholdDb = params.thresholdDb;
+    dynamics.computer.ratio = params.ratio;
+    dynamics.computer.kneeDb = 6.0f;
+    dynamics.gateThresholdDb = params.gateThresholdDb;
+    dynamics.makeupDb = params.makeupDb;
+    
+    // One-pole coefficients reaching 1 - 1/e of a step in the given time
+    dynamics.attackCoefficient = static_cast<float>(std::exp(-1.0 / (params.attackMs * 0.001 * currentSampleRate)));
+    dynamics.releaseCoefficient = static_cast<float>(std::exp(-1.0 / (params.releaseMs * 0.001 * currentSampleRate)));
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "../Preset/PresetSchema.h"
+#include "../Utils/ScratchArena.h"
+#include "GainComputer.h"
+#include "SIMDBiquad.h"
+#include <array>
+#include <atomic>
+
+/**
+ * Multiband compressor/gate for tightening the low end without squashing the highs
+ * The input is split into 2 to 4 bands by fourth-order Linkwitz-Riley
+ * crossovers arranged as a tree: one split into a low and a high half, then
+ * one split inside each half. Every filter of a tree level runs as one lane
+ * of a SIMDBiquad row, both channels included, and allpasses in each half
+ * keep the summed bands flat. Each band has its own stereo-linked detector
+ * and gain computer, with an optional downward expander below a gate
+ * threshold, and the bands are weighted and summed in a single pass
+ */
+class MultibandDynamics
+{
+public:
+    MultibandDynamics();
+    ~MultibandDynamics();
+    
+    // Audio processing lifecycle
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels);
+    void processBlock(juce::AudioBuffer<float>& buffer);
+    void releaseResources();
+    
+    // Prepares with band and scratch storage carved from a chain's shared arena
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels, ScratchArena& arena);
+    
+    // Parameter control (block rate)
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+    
+    void setNumBands(int numBands);                         // 2 to 4
+    void setCrossover(int index, float frequencyHz);        // index 0 to 2, 40 to 16000 Hz
+    void setBand(int band, const MultibandDynamicsParams::Band& bandParams);
+    
+    // Apply parameters from preset
+    void applyParameters(const MultibandDynamicsParams& params);
+    
+    // Metering: deepest gain reduction per band in the last block, in dB
+    float getBandGainReduction(int band) const
+    {
+        return bandGainReduction[static_cast<size_t>(juce::jlimit(0, maxBands - 1, band))].load(std::memory_order_relaxed);
+    }
+    
+private:
+    static constexpr int maxBands = 4;
+    static constexpr int maxChannels = 2;
+    
+    // Parameters
+    bool enabled = true;
+    int numBands = 3;
+    std::array<float, 3> crossoverHz { 150.0f, 2500.0f, 6000.0f };
+    std::array<MultibandDynamicsParams::Band, maxBands> bandParams;
+    
+    // Crossover tree. The first level splits each channel into a low and a
+    // high half and applies the compensating allpass: lanes are
+    // {ch0 low, ch0 high, ch1 low, ch1 high}, two LR4 sections then the allpass.
+    // The second level splits each half into two slots: lanes are
+    // {ch0 slots 0-3, ch1 slots 0-3}, two LR4 sections. Halves with no split
+    // pass through slot 0 or 2 and leave the other slot silent
+    std::array<SIMDBiquad<2 * maxChannels>, 3> halfSplit;
+    std::array<SIMDBiquad<maxBands * maxChannels>, 2> slotSplit;
+    
+    // Band held by each slot, or -1 for a silent slot
+    std::array<int, maxBands> slotBand { 0, -1, 1, 2 };
+    
+    // Per-slot dynamics
+    struct SlotDynamics
+    {
+        GainComputer computer;
+        float gateThresholdDb = -90.0f;
+        float makeupDb = 0.0f;
+        float attackCoefficient = 0.0f;
+        float releaseCoefficient = 0.0f;
+        float envelopeDb = 0.0f;
+    };
+    
+    std::array<SlotDynamics, maxBands> slots;
+    
+    // Downward expansion below the gate threshold: 1:4, at most 80 dB deep
+    static constexpr float expanderSlope = 3.0f;
+    static constexpr float expanderRangeDb = 80.0f;
+    
+    // Storage from the arena: band signals per channel and slot, then levels
+    // and gains per slot, each one block long
+    ScratchArena ownArena;
+    std::array<std::array<float*, maxBands>, maxChannels> bandScratch {};
+    std::array<float*, maxBands> levelScratch {};
+    std::array<float*, maxBands> gainScratch {};
+    int maxBlockSize = 0;
+    int preparedChannels = 0;
+    
+    // Processing state
+    double currentSampleRate = 44100.0;
+    bool isPrepared = false;
+    
+    // Metering
+    std::array<std::atomic<float>, maxBands> bandGainReduction {};
+    
+    // Block processing
+    void processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples, std::array<float, maxBands>& deepestDb);
+    void splitBands(const juce::AudioBuffer<float>& buffer, int offset, int numSamples, int numChannels);
+    void computeSlotGains(int slot, int numSamples, int numChannels, float& deepestDb);
+    
+    // Parameter updates
+    void updateCrossovers();
+    void updateSlot(int slot);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultibandDynamics)
+};
@@ -0,0 +1,436 @@
+#include "NoiseGate.h"
+#include "../Utils/FastMath.h"
+
+NoiseGate::NoiseGate()
+{
+}
+
+NoiseGate::~NoiseGate()
+{
+}
+
+void NoiseGate::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    // Standalone use: the gate keeps its own arena
+    ownArena.reset();
+    prepareToPlay(sampleRate, samplesPerBlock, numChannels, ownArena);
+}
+
+void NoiseGate::prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels, ScratchArena& arena)
+{
+    currentSampleRate = sampleRate;
+    
+    // Detector and gain scratch for one block
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    levelScratch = arena.allocate(static_cast<size_t>(maxBlockSize));
+    gainScratch = arena.allocate(static_cast<size_t>(maxBlockSize));
+    
+    // Lookahead rings, one sample longer than the delay
+    lookaheadSamples = static_cast<int>(std::round(lookaheadMs * 0.001 * sampleRate));
+    const int ringSize = juce::nextPowerOfTwo(lookaheadSamples + 1);
+    lookaheadRings.assign(static_cast<size_t>(juce::jmax(1, numChannels)), nullptr);
+    
+    for (auto& ring : lookaheadRings)
+    {
+        ring = arena.allocate(static_cast<size_t>(ringSize));
+        std::fill(ring, ring + ringSize, 0.0f);
+    }
+    
+    lookaheadMask = ringSize - 1;
+    lookaheadWriteIndex = 0;
+    
+    // Step gain table, rendered on the audio thread whenever the pattern changes
+    stepTable = arena.allocate(static_cast<size_t>(maxSteps * pointsPerStep));
+    stepTableDirty = true;
+    stepTablePosition = 0.0;
+    
+    updateThresholds();
+    updateEnvelope();
+    updateStepIncrement();
+    
+    // Start settled: a gate closed, a ducker at unity
+    holdCounter = 0;
+    gateOpen = false;
+    gateGain = (gateMode == 1) ? 1.0f : 0.0f;
+    
+    isPrepared = true;
+}
+
+void NoiseGate::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    processBlock(buffer, nullptr);
+}
+
+void NoiseGate::processBlock(juce::AudioBuffer<float>& buffer, SidechainKey* key)
+{
+    if (!isPrepared)
+        return;
+    
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(lookaheadRings.size()));
+    
+    if (numChannels == 0 || numSamples == 0)
+        return;
+    
+    // Switched off, the audio still takes the lookahead delay, so turning the
+    // gate on or off never moves the signal in time
+    if (!enabled)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            applyDelayedGain(buffer.getWritePointer(channel), lookaheadRings[static_cast<size_t>(channel)], nullptr, numSamples);
+    
+        lookaheadWriteIndex = (lookaheadWriteIndex + numSamples) & lookaheadMask;
+        return;
+    }
+    
+    // Only ducking listens to the external key; gating cleans up the input itself
+    const bool keyed = gateMode == 1 && key != nullptr && key->isActive();
+    const float* keyLevelsDb = keyed ? key->getLevelsDb() : nullptr;
+    const int keyedSamples = keyed ? key->getNumSamples() : 0;
+    
+    if (gateMode == 2 && stepTableDirty)
+        renderStepTable();
+    
+    // Hosts may send more than they announced; run those in prepared-size chunks
+    float loudestDb = -120.0f;
+    
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+    {
+        const int length = juce::jmin(maxBlockSize, numSamples - offset);
+        const float* chunkKey = (offset + length <= keyedSamples) ? keyLevelsDb + offset : nullptr;
+        loudestDb = juce::jmax(loudestDb, processChunk(buffer, offset, length, chunkKey));
+    }
+    
+    // The UI polls these; it only needs the latest value, not ordering
+    currentGateState.store(gateGain, std::memory_order_relaxed);
+    inputLevel.store(loudestDb, std::memory_order_relaxed);
+}
+
+float NoiseGate::processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples, const float* keyLevelsDb)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(lookaheadRings.size()));
+    float* targets = levelScratch;
+    float* gains = gainScratch;
+    
+    // Detector levels in dB, either from the key or from the input
+    const float* levels = keyLevelsDb;
+    
+    if (levels == nullptr)
+    {
+        calculateLevels(buffer, offset, numSamples, numChannels);
+        levels = levelScratch;
+    }
+    
+    const float loudestDb = juce::FloatVectorOperations::findMaximum(levels, numSamples);
+    
+    // Gain while open and while closed. Ducking inverts the gate: the key
+    // opening it pulls the signal down
+    const float openGain = (gateMode == 1) ? 1.0f - rhythmicDepth : 1.0f;
+    const float closedGain = (gateMode == 1) ? 1.0f : 0.0f;
+    
+    // Open/hold/close state machine. Crossing the open threshold, or staying
+    // above the close threshold while open, reloads the hold counter; the gate
+    // is open while it is running. Everything is a compare or a select, so
+    // there are no data-dependent jumps as the level hovers around threshold.
+    // Targets overwrite the levels in place, one sample behind the read
+    const float openAbove = openThreshold;
+    const float closeAbove = closeThreshold;
+    const int holdTotal = holdSamples;
+    int counter = holdCounter;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float level = levels[i];
+        const bool retrigger = (level > openAbove) | ((counter > 0) & (level > closeAbove));
+        counter = retrigger ? holdTotal : std::max(counter - 1, 0);
+        targets[i] = (counter > 0) ? openGain : closedGain;
+    }
+    
+    holdCounter = counter;
+    gateOpen = counter > 0;
+    
+    // Gain smoothing: attack while moving towards the open gain, release while
+    // moving away from it, picked with a select
+    const float attack = attackCoefficient;
+    const float release = releaseCoefficient;
+    const float openDirection = openGain - closedGain;
+    float gain = gateGain;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float target = targets[i];
+        const float coefficient = ((target - gain) * openDirection > 0.0f) ? attack : release;
+        gain += coefficient * (target - gain);
+        gains[i] = gain;
+    }
+    
+    gateGain = gain;
+    
+    // The pattern carries its own ramps, so it goes on after the gate smoothing
+    if (gateMode == 2)
+        applyRhythmicGating(gains, numSamples);
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        applyDelayedGain(buffer.getWritePointer(channel, offset), lookaheadRings[static_cast<size_t>(channel)], gains, numSamples);
+    
+    lookaheadWriteIndex = (lookaheadWriteIndex + numSamples) & lookaheadMask;
+    return loudestDb;
+}
+
+void NoiseGate::calculateLevels(const juce::AudioBuffer<float>& buffer, int offset, int numSamples, int numChannels)
+{
+    float* levels = levelScratch;
+    
+    // Stereo-linked peak detector: the largest magnitude across channels
+    const float* first = buffer.getReadPointer(0, offset);
+    for (int i = 0; i < numSamples; ++i)
+        levels[i] = std::abs(first[i]);
+    
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        const float* input = buffer.getReadPointer(channel, offset);
+        for (int i = 0; i < numSamples; ++i)
+            levels[i] = juce::jmax(levels[i], std::abs(input[i]));
+    }
+    
+    FastMath::gainToDecibels(levels, levels, numSamples);
+}
+
+void NoiseGate::applyRhythmicGating(float* gains, int numSamples)
+{
+    // One lookup per sample. Positions are offsets from the block start rather
+    // than a running sum, and carry a tiny bias so edges that fall exactly on a
+    // sample are not rounded down; step edges then land on the same samples in
+    // realtime and in offline bounces, whatever the block size
+    const float* table = stepTable;
+    const int mask = stepTableMask;
+    const double increment = stepTableIncrement;
+    const double start = stepTablePosition + 1.0e-6;
+    
+    for (int i = 0; i < numSamples; ++i)
+        gains[i] *= table[static_cast<int>(start + i * increment) & mask];
+    
+    stepTablePosition = std::fmod(stepTablePosition + numSamples * increment, static_cast<double>(mask + 1));
+}
+
+void NoiseGate::renderStepTable()
+{
+    // Each step holds its level, reached through a raised-cosine ramp from the
+    // previous step's level at the start of the step. The first step ramps
+    // from the last one, so the pattern loops seamlessly
+    const int rampPoints = static_cast<int>(std::round(rhythmicSmoothing * pointsPerStep));
+    const float offLevel = 1.0f - rhythmicDepth;
+    
+    auto stepLevel = [this, offLevel](int step)
+    {
+        return ((rhythmicPattern >> step) & 1u) != 0 ? 1.0f : offLevel;
+    };
+    
+    for (int step = 0; step < rhythmicSteps; ++step)
+    {
+        const float level = stepLevel(step);
+        const float previous = stepLevel((step + rhythmicSteps - 1) % rhythmicSteps);
+        float* points = stepTable + step * pointsPerStep;
+    
+        for (int i = 0; i < rampPoints; ++i)
+        {
+            const float shape = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * (static_cast<float>(i) + 0.5f) / static_cast<float>(rampPoints));
+            points[i] = previous + shape * (level - previous);
+        }
+    
+        std::fill(points + rampPoints, points + pointsPerStep, level);
+    }
+    
+    stepTableMask = rhythmicSteps * pointsPerStep - 1;
+    stepTableDirty = false;
+}
+
+void NoiseGate::applyDelayedGain(float* io, float* ring, const float* gains, int numSamples) const
+{
+    if (lookaheadSamples == 0)
+    {
+        if (gains != nullptr)
+            juce::FloatVectorOperations::multiply(io, gains, numSamples);
+    
+        return;
+    }
+    
+    // The audio runs lookaheadSamples behind the detector, so the gate is
+    // already open when a transient arrives. Spans stop where either index
+    // wraps and are never longer than the delay
+    const int ringSize = lookaheadMask + 1;
+    int done = 0;
+    
+    while (done < numSamples)
+    {
+        const int writeIndex = (lookaheadWriteIndex + done) & lookaheadMask;
+        const int readIndex = (writeIndex - lookaheadSamples) & lookaheadMask;
+        const int length = juce::jmin(juce::jmin(numSamples - done, lookaheadSamples),
+                                      juce::jmin(ringSize - writeIndex, ringSize - readIndex));
+    
+        float* block = io + done;
+        const float* blockGains = (gains != nullptr) ? gains + done : nullptr;
+        const float* read = ring + readIndex;
+        float* write = ring + writeIndex;
+    
+        if (gains != nullptr)
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                const float input = block[i];
+                block[i] = read[i] * blockGains[i];
+                write[i] = input;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                const float input = block[i];
+                block[i] = read[i];
+                write[i] = input;
+            }
+        }
+    
+        done += length;
+    }
+}
+
+void NoiseGate::releaseResources()
+{
+    // The storage belongs to whichever arena it came from
+    levelScratch = nullptr;
+    gainScratch = nullptr;
+    lookaheadRings.clear();
+    ownArena.reset();
+    isPrepared = false;
+}
+
+void NoiseGate::setThreshold(float newThresholdDb)
+{
+    thresholdDb = juce::jlimit(-90.0f, 0.0f, newThresholdDb);
+    updateThresholds();
+}
+
+void NoiseGate::setRelease(float newReleaseMs)
+{
+    releaseMs = juce::jlimit(5.0f, 500.0f, newReleaseMs);
+    updateEnvelope();
+}
+
+void NoiseGate::setAttack(float newAttackMs)
+{
+    attackMs = juce::jlimit(0.1f, 50.0f, newAttackMs);
+    updateEnvelope();
+}
+
+void NoiseGate::setHold(float newHoldMs)
+{
+    holdMs = juce::jlimit(0.0f, 100.0f, newHoldMs);
+    updateEnvelope();
+}
+
+void NoiseGate::setHysteresis(float newHysteresisDb)
+{
+    hysteresisDb = juce::jlimit(0.0f, 10.0f, newHysteresisDb);
+    updateThresholds();
+}
+
+void NoiseGate::setGateMode(int mode)
+{
+    gateMode = juce::jlimit(0, 2, mode);
+}
+
+void NoiseGate::setRhythmicDepth(float depth)
+{
+    // The chain sets these every block; only a real change re-renders the table
+    depth = juce::jlimit(0.0f, 1.0f, depth);
+    if (depth == rhythmicDepth)
+        return;
+    
+    rhythmicDepth = depth;
+    stepTableDirty = true;
+}
+
+void NoiseGate::setRhythmicPattern(juce::uint32 stepMask, int numSteps)
+{
+    const int steps = (numSteps >= maxSteps) ? maxSteps : 16;
+    if (stepMask == rhythmicPattern && steps == rhythmicSteps)
+        return;
+    
+    // Keep the same place in the bar when the step count changes
+    stepTablePosition *= static_cast<double>(steps) / static_cast<double>(rhythmicSteps);
+    
+    rhythmicPattern = stepMask;
+    rhythmicSteps = steps;
+    stepTableDirty = true;
+    updateStepIncrement();
+}
+
+void NoiseGate::setRhythmicSmoothing(float fractionOfStep)
+{
+    fractionOfStep = juce::jlimit(0.0f, 0.5f, fractionOfStep);
+    if (fractionOfStep == rhythmicSmoothing)
+        return;
+    
+    rhythmicSmoothing = fractionOfStep;
+    stepTableDirty = true;
+}
+
+void NoiseGate::setTransport(double ppqPosition, double bpm, bool isPlaying)
+{
+    if (bpm > 0.0 && bpm != transportBpm)
+    {
+        transportBpm = bpm;
+        updateStepIncrement();
+    }
+    
+    if (!isPlaying)
+        return;
+    
+    // The pattern spans one bar of four beats starting at PPQ zero. The gain
+    // lands on audio lookaheadSamples behind the block, which the host
+    // compensates as latency, so the table is read that far back
+    const double stepsPerBeat = rhythmicSteps / 4.0;
+    const double lookaheadSteps = lookaheadSamples * stepTableIncrement / pointsPerStep;
+    double step = std::fmod(ppqPosition * stepsPerBeat - lookaheadSteps, static_cast<double>(rhythmicSteps));
+    
+    if (step < 0.0)
+        step += rhythmicSteps;
+    
+    stepTablePosition = step * pointsPerStep;
+}
+
+void NoiseGate::applyParameters(const NoiseGateParams& params)
+{
+    setEnabled(params.enabled);
+    setThreshold(params.thresholdDb);
+    setRelease(params.releaseMs);
+    setGateMode(params.mode);
+    setRhythmicPattern(params.pattern, params.steps);
+    setRhythmicSmoothing(params.smoothing);
+    setRhythmicDepth(params.depth);
+}
+
+void NoiseGate::updateThresholds()
+{
+    // Opens at the threshold and closes once the level falls hysteresisDb below it
+    openThreshold = thresholdDb;
+    closeThreshold = thresholdDb - hysteresisDb;
+}
+
+void NoiseGate::updateEnvelope()
+{
+    // One-pole steps reaching 1 - 1/e of the way in the given time
+    attackCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (attackMs * 0.001 * currentSampleRate)));
+    releaseCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (releaseMs * 0.001 * currentSampleRate)));
+    
+    holdSamples = juce::jmax(1, static_cast<int>(std::round((holdMs + zeroCrossingGuardMs) * 0.001 * currentSampleRate)));
+}
+
+void NoiseGate::updateStepIncrement()
+{
+    // Table points per sample: beats per sample, times steps per beat, times points per step
+    const double stepsPerBeat = rhythmicSteps / 4.0;
+    stepTableIncrement = transportBpm / (60.0 * currentSampleRate) * stepsPerBeat * pointsPerStep;
+}
@@ -1,11 +1,18 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
 #include "../Preset/PresetSchema.h"
+#include "../Utils/ScratchArena.h"
+#include "SidechainKey.h"
+#include <atomic>
+#include <vector>
 
 /**
  * Noise gate for clean signal processing
- * Includes creative gating effects for rhythmic and abstract sounds
+ * Includes creative gating effects for rhythmic and abstract sounds.
+ * Detector levels for a block are computed in one vectorized pass; the
+ * open/hold/close state machine then runs per sample on selects rather
+ * than branches, and the gain is applied to the lookahead-delayed audio
  */
 class NoiseGate
 {
@@ -18,6 +25,13 @@ public:
     void processBlock(juce::AudioBuffer<float>& buffer);
     void releaseResources();
     
+    // Prepares with delay and scratch storage carved from a chain's shared arena.
+    // The arena must outlive the gate, or be reset only before preparing again
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels, ScratchArena& arena);
+    
+    // Ducking (gate mode 1) follows the key when one is given, otherwise the input
+    void processBlock(juce::AudioBuffer<float>& buffer, SidechainKey* key);
+    
     // Parameter control
     void setEnabled(bool enabled) { this->enabled = enabled; }
     bool isEnabled() const { return enabled; }
@@ -28,20 +42,33 @@ public:
     // Advanced parameters for creative gating
     void setAttack(float attackMs);         // 0.1 to 50 ms
     void setHold(float holdMs);             // 0 to 100 ms
-    void setLookahead(float lookaheadMs);   // 0 to 5 ms
     void setHysteresis(float hysteresisDb); // 0 to 10 dB (prevents chattering)
     
     // Creative gating modes
     void setGateMode(int mode);             // 0=normal, 1=ducking, 2=rhythmic
-    void setRhythmicRate(float rateHz);     // 0.1 to 10 Hz (for rhythmic gating)
-    void setRhythmicDepth(float depth);     // 0 to 1
+    void setRhythmicDepth(float depth);     // 0 to 1 (also how far ducking pulls down)
+    
+    // Step pattern for rhythmic gating, one bit per step (bit 0 first). A
+    // pattern spans one 4/4 bar, so 16 steps are sixteenths and 32 are
+    // thirty-seconds. Smoothing is the ramp into each change, as a fraction
+    // of a step
+    void setRhythmicPattern(juce::uint32 stepMask, int numSteps);   // 16 or 32 steps
+    void setRhythmicSmoothing(float fractionOfStep);                // 0 to 0.5
+    
+    // Host position at the start of the next block (audio thread). Steps
+    // follow the PPQ position while playing and free-run at the tempo when stopped
+    void setTransport(double ppqPosition, double bpm, bool isPlaying);
     
     // Apply parameters from preset
     void applyParameters(const NoiseGateParams& params);
     
-    // Metering
-    float getCurrentGateState() const { return currentGateState; }
-    float getInputLevel() const { return inputLevel; }
+    // The lookahead delay. Audio goes through it whenever the gate is
+    // prepared, enabled or not, so the latency holds while running
+    int getLatencyInSamples() const { return lookaheadSamples; }
+    
+    // Metering, published once per block; safe to poll from the UI
+    float getCurrentGateState() const { return currentGateState.load(std::memory_order_relaxed); }
+    float getInputLevel() const { return inputLevel.load(std::memory_order_relaxed); }   // peak, dB
     
 private:
     // Parameters
@@ -50,31 +77,60 @@ private:
     float releaseMs = 100.0f;
     float attackMs = 1.0f;
     float holdMs = 10.0f;
-    float lookaheadMs = 1.0f;
     float hysteresisDb = 3.0f;
     
     // Creative parameters
     int gateMode = 0; // 0=normal, 1=ducking, 2=rhythmic
-    float rhythmicRate = 2.0f;
     float rhythmicDepth = 0.8f;
-    
-    // DSP components
-    juce::dsp::DelayLine<float> lookaheadDelayL, lookaheadDelayR;
-    juce::dsp::Oscillator<float> rhythmicLFO;
-    
-    // Envelope detection
-    juce::SmoothedValue<float> gateEnvelope;
+    juce::uint32 rhythmicPattern = 0x5555;  // every other sixteenth
+    int rhythmicSteps = 16;
+    float rhythmicSmoothing = 0.1f;
+    
+    // Storage: the gate's own arena unless a chain shares one
+    ScratchArena ownArena;
+    float* levelScratch = nullptr;          // detector levels, then gate targets
+    float* gainScratch = nullptr;           // smoothed gate gain
+    int maxBlockSize = 0;
+    
+    // Lookahead: a fixed delay through one power-of-two ring per channel, from the arena
+    static constexpr float lookaheadMs = 1.0f;
+    std::vector<float*> lookaheadRings;
+    int lookaheadMask = 0;
+    int lookaheadWriteIndex = 0;
+    int lookaheadSamples = 0;
+    
+    // Rhythmic gating: the pattern, ramps included, is rendered into a gain
+    // table of pointsPerStep entries per step, so playing it back costs one
+    // lookup per sample. The table lives in the arena, sized for 32 steps
+    static constexpr int pointsPerStep = 1024;
+    static constexpr int maxSteps = 32;
+    float* stepTable = nullptr;
+    int stepTableMask = 0;
+    bool stepTableDirty = true;
+    
+    // Playback position in table points, and its per-sample step at the current tempo
+    double stepTablePosition = 0.0;
+    double stepTableIncrement = 0.0;
+    double transportBpm = 120.0;
+    
+    // Envelope: one-pole gain smoothing, attack when opening and release when closing
+    float attackCoefficient = 0.0f;
+    float releaseCoefficient = 0.0f;
+    float gateGain = 0.0f;
     
     // Processing state
     double currentSampleRate = 44100.0;
     bool isPrepared = false;
     bool gateOpen = false;
     
-    // Hold timer
+    // Hold timer, counting down once the level falls below the close threshold.
+    // A short guard is always added so the zero crossings of low notes never
+    // close the gate on their own
+    static constexpr float zeroCrossingGuardMs = 10.0f;
     int holdSamples = 0;
     int holdCounter = 0;
     
-    // Hysteresis thresholds
+    // Hysteresis thresholds (dB): opening needs the higher one
     float openThreshold = 0.0f;
     float closeThreshold = 0.0f;
     
@@ -82,21 +138,22 @@ private:
     std::atomic<float> currentGateState{0.0f};
     std::atomic<float> inputLevel{0.0f};
     
-    // Gate state calculation
-    bool shouldGateOpen(float inputLevel);
-    bool shouldGateClose(float inputLevel);
+    // Block processing
+    // Returns the loudest detector level in the chunk, in dB
+    float processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples, const float* keyLevelsDb);
+    void applyDelayedGain(float* io, float* ring, const float* gains, int numSamples) const;
     
-    // Level detection
-    float calculateLevel(const float* samples, int numSamples);
+    // Level detection: per-sample stereo-linked level in dB, into levelScratch
+    void calculateLevels(const juce::AudioBuffer<float>& buffer, int offset, int numSamples, int numChannels);
     
     // Creative gating
-    float calculateRhythmicGating();
-    float calculateDuckingGating(float inputLevel);
+    void applyRhythmicGating(float* gains, int numSamples);
+    void renderStepTable();
     
     // Parameter updates
     void updateThresholds();
     void updateEnvelope();
-    void updateRhythmicLFO();
+    void updateStepIncrement();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoiseGate)
 };
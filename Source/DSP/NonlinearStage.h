@@ -0,0 +1,27 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * The nonlinear part of a processing block, runnable at any sample rate
+ * An OversamplingRegion runs a sequence of these between a single
+ * upsampler and downsampler, so adjacent nonlinear stages share one pair of
+ * resampling filters instead of each paying for its own
+ */
+class NonlinearStage
+{
+public:
+    virtual ~NonlinearStage() = default;
+
+    // Stages with rate-dependent state are told the rate they will run at
+    virtual void prepareNonlinear(double sampleRate, int maximumBlockSize)
+    {
+        juce::ignoreUnused(sampleRate, maximumBlockSize);
+    }
+
+    // Inactive stages are skipped; a region with no active stage is bypassed
+    virtual bool isNonlinearActive() const = 0;
+
+    // In-place processing of numChannels channels at the rate given to prepareNonlinear
+    virtual void processNonlinear(float* const* channels, int numChannels, int numSamples) = 0;
+};
@@ -0,0 +1,217 @@
+#include "OversamplingRegion.h"
+
+namespace
+{
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+    
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+    
+        return sum;
+    }
+    
+    constexpr int upHistory = 15;       // phaseTaps - 1
+    constexpr int evenHistory = 15;     // phaseTaps - 1
+    constexpr int oddHistory = 8;       // centreDelay + 1
+}
+
+OversamplingRegion::OversamplingRegion()
+{
+    // Windowed sinc with its cutoff at a quarter of the oversampled rate,
+    // keeping only the even-index taps; the centre tap is the delay phase
+    const int centre = (halfbandTaps - 1) / 2;
+    double sum = 0.0;
+    
+    for (int j = 0; j < phaseTaps; ++j)
+    {
+        const double t = 2.0 * j - centre;
+        const double sinc = std::sin(juce::MathConstants<double>::halfPi * t) / (juce::MathConstants<double>::pi * t);
+        const double ratio = t / centre;
+        const double window = besselI0(kaiserBeta * std::sqrt(1.0 - ratio * ratio)) / besselI0(kaiserBeta);
+        phaseCoefficients[static_cast<size_t>(j)] = static_cast<float>(sinc * window);
+        sum += sinc * window;
+    }
+    
+    // Each phase of a halfband sums to one half; the factor of two for
+    // upsampling is folded in here, and downsampling halves it again
+    for (auto& coefficient : phaseCoefficients)
+        coefficient = static_cast<float>(coefficient / sum);
+}
+
+OversamplingRegion::~OversamplingRegion()
+{
+}
+
+void OversamplingRegion::prepare(double sampleRate, int maximumBlockSize, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+    
+    channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+    for (auto& state : channels)
+    {
+        state.upInput.assign(static_cast<size_t>(upHistory + maxBlockSize), 0.0f);
+        state.downEven.assign(static_cast<size_t>(evenHistory + maxBlockSize), 0.0f);
+        state.downOdd.assign(static_cast<size_t>(oddHistory + maxBlockSize), 0.0f);
+        state.oversampled.assign(static_cast<size_t>(factor * maxBlockSize), 0.0f);
+    }
+    
+    oversampledPointers.assign(channels.size(), nullptr);
+    accumulator.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    
+    downsamplerCurrent = false;
+    isPrepared = true;
+}
+
+void OversamplingRegion::reset()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.upInput.begin(), state.upInput.end(), 0.0f);
+        std::fill(state.downEven.begin(), state.downEven.end(), 0.0f);
+        std::fill(state.downOdd.begin(), state.downOdd.end(), 0.0f);
+    }
+}
+
+void OversamplingRegion::process(juce::AudioBuffer<float>& buffer, NonlinearStage* const* stages, int numStages)
+{
+    if (!isPrepared)
+        return;
+    
+    // After delay() the upsampler history is current but the downsampler's is not
+    if (!downsamplerCurrent)
+    {
+        for (auto& state : channels)
+        {
+            std::fill(state.downEven.begin(), state.downEven.end(), 0.0f);
+            std::fill(state.downOdd.begin(), state.downOdd.end(), 0.0f);
+        }
+    
+        downsamplerCurrent = true;
+    }
+    
+    // Hosts may send more than they announced; run those in prepared-size chunks
+    const int numSamples = buffer.getNumSamples();
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+        processChunk(buffer, offset, juce::jmin(maxBlockSize, numSamples - offset), stages, numStages);
+}
+
+void OversamplingRegion::delay(juce::AudioBuffer<float>& buffer)
+{
+    if (!isPrepared)
+        return;
+    
+    // The upsampler's input history is exactly the delay long, so it doubles
+    // as the delay line and stays ready for process()
+    static_assert(upHistory == getLatencyInSamples(), "The delay runs through the upsampler history");
+    
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(channels.size()));
+    
+    for (int offset = 0; offset < buffer.getNumSamples(); offset += maxBlockSize)
+    {
+        const int numSamples = juce::jmin(maxBlockSize, buffer.getNumSamples() - offset);
+    
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* history = channels[static_cast<size_t>(channel)].upInput.data();
+            float* io = buffer.getWritePointer(channel, offset);
+    
+            std::copy(io, io + numSamples, history + upHistory);
+            std::copy(history, history + numSamples, io);
+            std::copy(history + numSamples, history + numSamples + upHistory, history);
+        }
+    }
+    
+    downsamplerCurrent = false;
+}
+
+void OversamplingRegion::processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples,
+                                      NonlinearStage* const* stages, int numStages)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(channels.size()));
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = channels[static_cast<size_t>(channel)];
+        upsample(state, buffer.getReadPointer(channel, offset), numSamples);
+        oversampledPointers[static_cast<size_t>(channel)] = state.oversampled.data();
+    }
+    
+    // Every stage in the run at the higher rate, back to back
+    for (int stage = 0; stage < numStages; ++stage)
+        if (stages[stage] != nullptr && stages[stage]->isNonlinearActive())
+            stages[stage]->processNonlinear(oversampledPointers.data(), numChannels, factor * numSamples);
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        downsample(channels[static_cast<size_t>(channel)], buffer.getWritePointer(channel, offset), numSamples);
+}
+
+void OversamplingRegion::upsample(ChannelState& state, const float* input, int numSamples)
+{
+    float* history = state.upInput.data();
+    std::copy(input, input + numSamples, history + upHistory);
+    
+    // Even outputs: the 16-tap phase. Tap by tap over the whole block, so
+    // each inner loop is a contiguous multiply-add
+    float* even = accumulator.data();
+    std::fill(even, even + numSamples, 0.0f);
+    
+    for (int j = 0; j < phaseTaps; ++j)
+    {
+        const float coefficient = phaseCoefficients[static_cast<size_t>(j)];
+        const float* source = history + upHistory - j;
+    
+        for (int n = 0; n < numSamples; ++n)
+            even[n] += coefficient * source[n];
+    }
+    
+    // Odd outputs: the centre tap alone, a pure delay
+    float* output = state.oversampled.data();
+    const float* delayed = history + upHistory - centreDelay;
+    
+    for (int n = 0; n < numSamples; ++n)
+    {
+        output[2 * n] = even[n];
+        output[2 * n + 1] = delayed[n];
+    }
+    
+    std::copy(history + numSamples, history + numSamples + upHistory, history);
+}
+
+void OversamplingRegion::downsample(ChannelState& state, float* output, int numSamples)
+{
+    float* even = state.downEven.data();
+    float* odd = state.downOdd.data();
+    const float* input = state.oversampled.data();
+    
+    // Split into phases, so both filters read contiguous history
+    for (int n = 0; n < numSamples; ++n)
+    {
+        even[evenHistory + n] = input[2 * n];
+        odd[oddHistory + n] = input[2 * n + 1];
+    }
+    
+    // Odd phase: the centre tap, half of a pure delay; even phase: the 16 taps, halved
+    const float* delayed = odd + oddHistory - (centreDelay + 1);
+    for (int n = 0; n < numSamples; ++n)
+        output[n] = 0.5f * delayed[n];
+    
+    for (int j = 0; j < phaseTaps; ++j)
+    {
+        const float coefficient = 0.5f * phaseCoefficients[static_cast<size_t>(j)];
+        const float* source = even + evenHistory - j;
+    
+        for (int n = 0; n < numSamples; ++n)
+            output[n] += coefficient * source[n];
+    }
+    
+    std::copy(even + numSamples, even + numSamples + evenHistory, even);
+    std::copy(odd + numSamples, odd + numSamples + oddHistory, odd);
+}
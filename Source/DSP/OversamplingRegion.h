@@ -0,0 +1,78 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "NonlinearStage.h"
+#include <array>
+#include <vector>
+
+/**
+ * 2x oversampling around a run of nonlinear stages
+ * Upsamples once, runs every active stage in order at twice the rate, then
+ * downsamples once. Both directions use the same 31-tap Kaiser-windowed
+ * halfband FIR in polyphase form: half its taps are zero and one phase is
+ * a pure delay, so each direction costs 16 multiply-adds per input sample,
+ * computed as flat loops over contiguous history that vectorize
+ */
+class OversamplingRegion
+{
+public:
+    OversamplingRegion();
+    ~OversamplingRegion();
+    
+    static constexpr int factor = 2;
+    
+    // Allocates history and the oversampled buffer, and prepares the stages
+    // given to process() separately, at getOversampledRate()
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+    
+    // Runs the active stages at the oversampled rate, in order. With none
+    // active the audio still goes through both filters, so the region's
+    // delay never changes and a run coming back in finds its history intact
+    void process(juce::AudioBuffer<float>& buffer, NonlinearStage* const* stages, int numStages);
+    
+    // Delays the audio by getLatencyInSamples() without filtering, for a
+    // section running its stages at the base rate but keeping its latency
+    void delay(juce::AudioBuffer<float>& buffer);
+    
+    double getOversampledRate() const { return currentSampleRate * factor; }
+    
+    // Delay added by the up and down filters together, in base-rate samples
+    static constexpr int getLatencyInSamples() { return halfbandTaps / 2; }
+    
+private:
+    // Halfband design: the centre tap is 0.5, taps at even distances from it
+    // are zero, and the 16 remaining taps sit at even indices
+    static constexpr int halfbandTaps = 31;
+    static constexpr int phaseTaps = (halfbandTaps + 1) / 2;
+    static constexpr int centreDelay = (halfbandTaps - 1) / 4;     // of the delay phase, in base samples
+    static constexpr double kaiserBeta = 8.0;
+    std::array<float, phaseTaps> phaseCoefficients {};
+    
+    // Per channel: [history | block] for the upsampler input and for the even
+    // and odd phases of the oversampled signal, plus the oversampled signal
+    struct ChannelState
+    {
+        std::vector<float> upInput;
+        std::vector<float> downEven;
+        std::vector<float> downOdd;
+        std::vector<float> oversampled;
+    };
+    
+    std::vector<ChannelState> channels;
+    std::vector<float*> oversampledPointers;
+    std::vector<float> accumulator;
+    
+    // Processing state
+    double currentSampleRate = 44100.0;
+    int maxBlockSize = 0;
+    bool isPrepared = false;
+    bool downsamplerCurrent = false;    // false after delay(), whose blocks skip the downsampler
+    
+    void upsample(ChannelState& state, const float* input, int numSamples);
+    void downsample(ChannelState& state, float* output, int numSamples);
+    void processChunk(juce::AudioBuffer<float>& buffer, int offset, int numSamples,
+                      NonlinearStage* const* stages, int numStages);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OversamplingRegion)
+};
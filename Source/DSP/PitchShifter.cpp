@@ -0,0 +1,89 @@
+#include "PitchShifter.h"
+
+PitchShifter::PitchShifter()
+{
+    for (int i = 0; i <= windowSize; ++i)
+    {
+        const float s = std::sin(juce::MathConstants<float>::pi * static_cast<float>(i) / windowSize);
+        window[static_cast<size_t>(i)] = s * s;
+    }
+}
+
+PitchShifter::~PitchShifter()
+{
+}
+
+void PitchShifter::prepare(double sampleRate, float grainMs)
+{
+    grainSamples = juce::jmax(64.0f, static_cast<float>(sampleRate * grainMs * 0.001));
+
+    const int size = juce::nextPowerOfTwo(static_cast<int>(grainSamples) + 4);
+    buffer.assign(static_cast<size_t>(size), 0.0f);
+    bufferMask = size - 1;
+
+    setPitch(pitchSemitones);
+    reset();
+}
+
+void PitchShifter::reset()
+{
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    writeIndex = 0;
+    phase = 0.0f;
+}
+
+void PitchShifter::setPitch(float semitones)
+{
+    pitchSemitones = juce::jlimit(-24.0f, 24.0f, semitones);
+
+    // The taps' delay changes by (1 - ratio) samples per sample, which plays
+    // the buffer back at 'ratio' times the input speed
+    const float ratio = std::pow(2.0f, pitchSemitones / 12.0f);
+    phaseIncrement = (1.0f - ratio) / grainSamples;
+}
+
+float PitchShifter::processSample(float input)
+{
+    buffer[static_cast<size_t>(writeIndex)] = input;
+
+    float phaseB = phase + 0.5f;
+    if (phaseB >= 1.0f)
+        phaseB -= 1.0f;
+
+    // Each tap is silent while it jumps across the grain boundary
+    const float output = readTap(1.0f + phase * grainSamples) * windowAt(phase)
+                       + readTap(1.0f + phaseB * grainSamples) * windowAt(phaseB);
+
+    phase += phaseIncrement;
+    if (phase >= 1.0f)
+        phase -= 1.0f;
+    else if (phase < 0.0f)
+        phase += 1.0f;
+
+    writeIndex = (writeIndex + 1) & bufferMask;
+
+    return output;
+}
+
+float PitchShifter::readTap(float delaySamples) const
+{
+    const float position = static_cast<float>(writeIndex) - delaySamples;
+    const float floored = std::floor(position);
+    const float fraction = position - floored;
+    const int index = static_cast<int>(floored);
+
+    const float a = buffer[static_cast<size_t>(index & bufferMask)];
+    const float b = buffer[static_cast<size_t>((index + 1) & bufferMask)];
+
+    return a + fraction * (b - a);
+}
+
+float PitchShifter::windowAt(float grainPhase) const
+{
+    const float position = grainPhase * windowSize;
+    const int index = juce::jmin(static_cast<int>(position), windowSize - 1);
+    const float fraction = position - static_cast<float>(index);
+
+    return window[static_cast<size_t>(index)]
+         + fraction * (window[static_cast<size_t>(index + 1)] - window[static_cast<size_t>(index)]);
+}
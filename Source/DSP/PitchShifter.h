@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+
+/**
+ * Streaming granular pitch shifter
+ * Two read taps sweep through a short delay line half a grain apart and are
+ * crossfaded with complementary sin^2 windows, so state carries across blocks
+ * and latency is bounded by the grain length
+ */
+class PitchShifter
+{
+public:
+    PitchShifter();
+    ~PitchShifter();
+
+    // Audio processing lifecycle
+    void prepare(double sampleRate, float grainMs = 60.0f);
+    void reset();
+
+    // Parameter control
+    void setPitch(float semitones);     // -24 to +24 semitones
+
+    // Per-sample processing so the shifter can sit inside a feedback loop
+    float processSample(float input);
+
+    // Average delay through the shifter
+    int getLatencyInSamples() const { return static_cast<int>(grainSamples * 0.5f); }
+
+private:
+    static constexpr int windowSize = 512;
+
+    // Delay storage
+    std::vector<float> buffer;
+    int bufferMask = 0;
+    int writeIndex = 0;
+
+    // Grain state: phase runs 0..1 over one grain, tap B trails tap A by half a grain
+    float grainSamples = 2646.0f;
+    float phase = 0.0f;
+    float phaseIncrement = 0.0f;
+    float pitchSemitones = 12.0f;
+
+    // sin^2 crossfade window; windowAt(p) + windowAt(p + 0.5) == 1
+    std::array<float, windowSize + 1> window {};
+
+    float readTap(float delaySamples) const;
+    float windowAt(float grainPhase) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchShifter)
+};
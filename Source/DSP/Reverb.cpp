@@ -1,7 +1,6 @@
 #include "Reverb.h"
 
 Reverb::Reverb()
-    : shimmerOversampler(2, 2, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR)
 {
 }
 
@@ -13,6 +12,7 @@ void Reverb::prepareToPlay(double sampleRate, int samplesPerBlock, int numChanne
 {
     currentSampleRate = sampleRate;
     currentNumChannels = numChannels;
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
     
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
@@ -20,40 +20,25 @@ void Reverb::prepareToPlay(double sampleRate, int samplesPerBlock, int numChanne
     spec.numChannels = static_cast<juce::uint32>(numChannels);
     
     // Initialize main reverb
-    juceReverb.prepare(spec);
+    fdn.prepare(sampleRate);
+    convolution.prepare(sampleRate, maxBlockSize);
     updateReverbParameters();
     
     // Initialize pre-delay
     preDelayLine.prepare(spec);
     preDelayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 0.06)); // 60ms max
     
-    // Initialize shimmer components
-    shimmerOversampler.reset();
-    shimmerOversampler.initProcessing(static_cast<size_t>(samplesPerBlock));
+    // Allocate the dry copy once; processBlock never resizes it
+    dryBuffer.setSize(numChannels, maxBlockSize, false, true, false);
     
-    // Initialize FFT for pitch shifting (shimmer effect)
-    int fftOrder = 11; // 2048 samples
-    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
-    fftBuffer.resize(static_cast<size_t>(fft->getSize() * 2));
-    
-    shimmerBuffer.setSize(numChannels, samplesPerBlock);
-    
-    // Initialize modulation LFOs
-    lfoL.prepare(spec);
-    lfoR.prepare(spec);
+    // Initialize modulation LFOs at control rate; the FDN interpolates between steps
+    juce::dsp::ProcessSpec controlSpec = spec;
+    controlSpec.sampleRate = sampleRate / modulationInterval;
+    lfoL.prepare(controlSpec);
+    lfoR.prepare(controlSpec);
     lfoL.initialise([](float x) { return std::sin(x); });
     lfoR.initialise([](float x) { return std::sin(x); });
-    
-    // Initialize modulation delay lines
-    modulationDelayL.prepare(spec);
-    modulationDelayR.prepare(spec);
-    modulationDelayL.setMaximumDelayInSamples(static_cast<int>(sampleRate * 0.02)); // 20ms max
-    modulationDelayR.setMaximumDelayInSamples(static_cast<int>(sampleRate * 0.02));
-    
-    // Initialize damping filters
-    dampingFilterL.prepare(spec);
-    dampingFilterR.prepare(spec);
-    updateDampingFilter();
+    samplesUntilModulationUpdate = 0;
     
     updateModulation();
     
@@ -65,82 +50,92 @@ void Reverb::processBlock(juce::AudioBuffer<float>& buffer)
     if (!isPrepared || !enabled)
         return;
     
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
+    const int numChannels = juce::jmin(buffer.getNumChannels(), dryBuffer.getNumChannels());
+    const int totalSamples = buffer.getNumSamples();
+    auto* const* channels = buffer.getArrayOfWritePointers();
     
-    // Store dry signal for mixing
-    juce::AudioBuffer<float> dryBuffer;
-    dryBuffer.makeCopyOf(buffer);
+    // Host blocks larger than the prepared size are split into prepared-size
+    // chunks so no scratch buffer ever has to grow on the audio thread
+    float* chunk[2] = { nullptr, nullptr };
+    const int chunkChannels = juce::jmin(numChannels, 2);
     
-    // Apply pre-delay
-    if (preDelayMs > 0.1f)
+    for (int start = 0; start < totalSamples; start += maxBlockSize)
     {
-        int delaySamples = static_cast<int>(preDelayMs * currentSampleRate / 1000.0f);
-        preDelayLine.setDelay(static_cast<float>(delaySamples));
+        const int numSamples = juce::jmin(maxBlockSize, totalSamples - start);
         
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float delayedSample = preDelayLine.popSample(channel);
-                preDelayLine.pushSample(channel, channelData[sample]);
-                channelData[sample] = delayedSample;
-            }
-        }
+        for (int channel = 0; channel < chunkChannels; ++channel)
+            chunk[channel] = channels[channel] + start;
+        
+        processChunk(chunk, chunkChannels, numSamples);
     }
+}
+
+void Reverb::processChunk(float* const* channels, int numChannels, int numSamples)
+{
+    if (numChannels == 0)
+        return;
     
-    // Process based on algorithm
-    switch (algorithm)
-    {
-        case ReverbAlgorithm::Room:
-            processRoom(buffer);
-            break;
-        case ReverbAlgorithm::Plate:
-            processPlate(buffer);
-            break;
-        case ReverbAlgorithm::Hall:
-            processHall(buffer);
-            break;
-        case ReverbAlgorithm::Shimmer:
-            processShimmer(buffer);
-            break;
-    }
+    // Store dry signal for mixing
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::copy(dryBuffer.getWritePointer(channel), channels[channel], numSamples);
     
-    // Apply damping filter
-    juce::dsp::AudioBlock<float> dampingBlock(buffer);
-    if (buffer.getNumChannels() >= 1)
-    {
-        juce::dsp::AudioBlock<float> monoBlockL(buffer.getArrayOfWritePointers(), 1, buffer.getNumSamples());
-        dampingFilterL.process(juce::dsp::ProcessContextReplacing<float>(monoBlockL));
-    }
-    if (buffer.getNumChannels() >= 2)
+    if (preDelayMs > 0.1f)
+        processPreDelay(channels, numChannels, numSamples);
+    
+    // Convolution replaces the FDN; the other algorithms differ only in its configuration
+    if (algorithm == ReverbAlgorithm::Convolution)
+        convolution.process(channels[0], numChannels > 1 ? channels[1] : nullptr, numSamples);
+    else
+        processNetwork(channels, numChannels, numSamples);
+    
+    mixDryWet(channels, numChannels, numSamples);
+}
+
+void Reverb::processPreDelay(float* const* channels, int numChannels, int numSamples)
+{
+    int delaySamples = static_cast<int>(preDelayMs * currentSampleRate / 1000.0f);
+    preDelayLine.setDelay(static_cast<float>(delaySamples));
+    
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        juce::dsp::AudioBlock<float> monoBlockR(buffer.getArrayOfWritePointers() + 1, 1, buffer.getNumSamples());
-        dampingFilterR.process(juce::dsp::ProcessContextReplacing<float>(monoBlockR));
+        auto* channelData = channels[channel];
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            float delayedSample = preDelayLine.popSample(channel);
+            preDelayLine.pushSample(channel, channelData[sample]);
+            channelData[sample] = delayedSample;
+        }
     }
+}
+
+void Reverb::mixDryWet(float* const* channels, int numChannels, int numSamples)
+{
+    // Fused crossfade, dry + mix * (wet - dry): one read of each buffer and one
+    // write, with no loop-carried state so the compiler vectorizes it
+    const float wetAmount = mix;
     
-    // Mix dry and wet signals
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        auto* wetData = buffer.getWritePointer(channel);
-        auto* dryData = dryBuffer.getReadPointer(channel);
+        auto* wetData = channels[channel];
+        const auto* dryData = dryBuffer.getReadPointer(channel);
         
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            wetData[sample] = dryData[sample] * (1.0f - mix) + wetData[sample] * mix;
-        }
+        for (int sample = 0; sample < numSamples; ++sample)
+            wetData[sample] = dryData[sample] + wetAmount * (wetData[sample] - dryData[sample]);
     }
 }
 
 void Reverb::releaseResources()
 {
-    juceReverb.reset();
+    fdn.reset();
+    convolution.release();
     isPrepared = false;
 }
 
 void Reverb::setAlgorithm(ReverbAlgorithm newAlgorithm)
 {
+    if (newAlgorithm == algorithm)
+        return;
+    
     algorithm = newAlgorithm;
     if (isPrepared)
         updateReverbParameters();
@@ -153,16 +148,24 @@ void Reverb::setPreDelay(float newPreDelayMs)
 
 void Reverb::setDecayTime(float newDecaySeconds)
 {
-    decaySeconds = juce::jlimit(0.2f, 12.0f, newDecaySeconds);
+    newDecaySeconds = juce::jlimit(0.2f, 12.0f, newDecaySeconds);
+    if (newDecaySeconds == decaySeconds)
+        return;
+    
+    decaySeconds = newDecaySeconds;
     if (isPrepared)
         updateReverbParameters();
 }
 
 void Reverb::setDamping(float newDamping)
 {
-    damping = juce::jlimit(0.0f, 1.0f, newDamping);
+    newDamping = juce::jlimit(0.0f, 1.0f, newDamping);
+    if (newDamping == damping)
+        return;
+    
+    damping = newDamping;
     if (isPrepared)
-        updateDampingFilter();
+        updateReverbParameters();
 }
 
 void Reverb::setMix(float newMix)
@@ -180,16 +183,32 @@ void Reverb::setModulationRate(float rateHz)
 void Reverb::setModulationDepth(float depth)
 {
     modulationDepth = juce::jlimit(0.0f, 1.0f, depth);
+    if (isPrepared)
+        updateModulation();
 }
 
 void Reverb::setShimmerPitch(float semitones)
 {
     shimmerPitch = juce::jlimit(-12.0f, 12.0f, semitones);
+    if (isPrepared)
+        updateReverbParameters();
 }
 
 void Reverb::setShimmerMix(float newShimmerMix)
 {
     shimmerMix = juce::jlimit(0.0f, 1.0f, newShimmerMix);
+    if (isPrepared)
+        updateReverbParameters();
+}
+
+void Reverb::loadImpulseResponse(juce::AudioBuffer<float>&& impulse, double impulseSampleRate)
+{
+    convolution.loadImpulseResponse(std::move(impulse), impulseSampleRate);
+}
+
+void Reverb::clearImpulseResponse()
+{
+    convolution.clearImpulseResponse();
 }
 
 void Reverb::applyParameters(const ReverbParams& params)
@@ -202,151 +221,82 @@ void Reverb::applyParameters(const ReverbParams& params)
     setMix(params.mix);
 }
 
-void Reverb::processRoom(juce::AudioBuffer<float>& buffer)
-{
-    // Room algorithm: shorter, more intimate reverb
-    juce::dsp::AudioBlock<float> block(buffer);
-    juceReverb.process(juce::dsp::ProcessContextReplacing<float>(block));
-}
-
-void Reverb::processPlate(juce::AudioBuffer<float>& buffer)
-{
-    // Plate algorithm: classic studio plate reverb sound
-    juce::dsp::AudioBlock<float> block(buffer);
-    juceReverb.process(juce::dsp::ProcessContextReplacing<float>(block));
-}
-
-void Reverb::processHall(juce::AudioBuffer<float>& buffer)
-{
-    // Hall algorithm: large, spacious reverb
-    juce::dsp::AudioBlock<float> block(buffer);
-    juceReverb.process(juce::dsp::ProcessContextReplacing<float>(block));
-}
-
-void Reverb::processShimmer(juce::AudioBuffer<float>& buffer)
+double Reverb::getTailLengthSeconds() const
 {
-    // Shimmer algorithm: reverb + pitch shifting for ethereal effects
+    const double reverbSeconds = (algorithm == ReverbAlgorithm::Convolution)
+                                     ? static_cast<double>(convolution.getTailLengthSeconds())
+                                     : static_cast<double>(decaySeconds);
     
-    // First apply regular reverb
-    juce::dsp::AudioBlock<float> block(buffer);
-    juceReverb.process(juce::dsp::ProcessContextReplacing<float>(block));
-    
-    // Then add shimmer effect
-    processShimmerEffect(buffer);
+    return preDelayMs * 0.001 + reverbSeconds;
 }
 
-void Reverb::processShimmerEffect(juce::AudioBuffer<float>& buffer)
+void Reverb::processNetwork(float* const* channels, int numChannels, int numSamples)
 {
-    // Create a copy for pitch shifting
-    shimmerBuffer.makeCopyOf(buffer);
-    
-    // Apply pitch shifting to the shimmer buffer
-    pitchShift(shimmerBuffer, shimmerPitch);
+    // Algorithms differ in line set, absorption and (for Shimmer) the pitch
+    // shifter in the feedback path
+    float* left = channels[0];
+    float* right = numChannels > 1 ? channels[1] : nullptr;
+    int processed = 0;
     
-    // Mix the pitch-shifted signal back into the main buffer
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    // The LFOs step once per modulationInterval samples, independent of the host
+    // block size; the FDN ramps its delay offsets per sample between steps
+    while (processed < numSamples)
     {
-        auto* mainData = buffer.getWritePointer(channel);
-        auto* shimmerData = shimmerBuffer.getReadPointer(channel);
-        
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        if (samplesUntilModulationUpdate == 0)
         {
-            mainData[sample] += shimmerData[sample] * shimmerMix;
+            fdn.setModulationTarget(lfoL.processSample(0.0f), lfoR.processSample(0.0f), modulationInterval);
+            samplesUntilModulationUpdate = modulationInterval;
         }
-    }
-}
-
-void Reverb::pitchShift(juce::AudioBuffer<float>& buffer, float semitones)
-{
-    // Simplified pitch shifting using time-domain stretching
-    // In a production implementation, you'd use more sophisticated algorithms
-    
-    float pitchRatio = std::pow(2.0f, semitones / 12.0f);
-    
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        auto* channelData = buffer.getWritePointer(channel);
         
-        // Simple pitch shifting by resampling (crude but effective for shimmer)
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            float sourceIndex = sample * pitchRatio;
-            int index1 = static_cast<int>(sourceIndex);
-            int index2 = index1 + 1;
-            
-            if (index2 < buffer.getNumSamples())
-            {
-                float fraction = sourceIndex - index1;
-                float interpolated = channelData[index1] * (1.0f - fraction) + 
-                                   channelData[index2] * fraction;
-                channelData[sample] = interpolated * 0.5f; // Reduce level
-            }
-            else
-            {
-                channelData[sample] = 0.0f;
-            }
-        }
+        const int length = juce::jmin(samplesUntilModulationUpdate, numSamples - processed);
+        fdn.process(left + processed, right != nullptr ? right + processed : nullptr, length);
+        
+        processed += length;
+        samplesUntilModulationUpdate -= length;
     }
 }
 
 void Reverb::updateReverbParameters()
 {
-    juce::Reverb::Parameters params;
-    
-    // Set parameters based on algorithm
+    // decaySeconds is the broadband RT60; damping shortens the treble RT60
+    // relative to it, scaled per algorithm
     switch (algorithm)
     {
         case ReverbAlgorithm::Room:
-            params.roomSize = 0.3f + (decaySeconds / 12.0f) * 0.4f;
-            params.damping = 0.5f + damping * 0.4f;
-            params.wetLevel = 1.0f;
-            params.dryLevel = 0.0f;
-            params.width = 0.8f;
+            fdn.setDelaySet(FDNReverb::roomDelays);
+            fdn.setHighFrequencyRatio(1.0f - damping * 0.85f);
             break;
             
         case ReverbAlgorithm::Plate:
-            params.roomSize = 0.5f + (decaySeconds / 12.0f) * 0.3f;
-            params.damping = 0.3f + damping * 0.5f;
-            params.wetLevel = 1.0f;
-            params.dryLevel = 0.0f;
-            params.width = 1.0f;
+            fdn.setDelaySet(FDNReverb::plateDelays);
+            fdn.setHighFrequencyRatio(1.0f - damping * 0.6f);
             break;
             
         case ReverbAlgorithm::Hall:
-            params.roomSize = 0.7f + (decaySeconds / 12.0f) * 0.3f;
-            params.damping = 0.2f + damping * 0.6f;
-            params.wetLevel = 1.0f;
-            params.dryLevel = 0.0f;
-            params.width = 1.0f;
+            fdn.setDelaySet(FDNReverb::hallDelays);
+            fdn.setHighFrequencyRatio(1.0f - damping * 0.8f);
             break;
             
         case ReverbAlgorithm::Shimmer:
-            params.roomSize = 0.8f + (decaySeconds / 12.0f) * 0.2f;
-            params.damping = 0.1f + damping * 0.4f;
-            params.wetLevel = 1.0f;
-            params.dryLevel = 0.0f;
-            params.width = 1.0f;
+            fdn.setDelaySet(FDNReverb::hallDelays);
+            fdn.setHighFrequencyRatio(1.0f - damping * 0.5f);
+            break;
+            
+        case ReverbAlgorithm::Convolution:
+            // Rebuilt on the convolution worker; a loaded IR takes precedence
+            convolution.setSyntheticResponse(decaySeconds, 1.0f - damping * 0.8f);
             break;
     }
     
-    juceReverb.setParameters(params);
-}
-
-void Reverb::updateDampingFilter()
-{
-    // High frequency damping filter
-    float cutoffHz = 20000.0f * (1.0f - damping);
-    cutoffHz = juce::jlimit(1000.0f, 20000.0f, cutoffHz);
-    
-    auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(
-        currentSampleRate, cutoffHz, 0.707f);
-    
-    *dampingFilterL.state = *coefficients;
-    *dampingFilterR.state = *coefficients;
+    fdn.setDecayTime(decaySeconds);
+    fdn.setShimmer(shimmerPitch, algorithm == ReverbAlgorithm::Shimmer ? shimmerMix : 0.0f);
 }
 
 void Reverb::updateModulation()
 {
     lfoL.setFrequency(static_cast<float>(modulationRate));
     lfoR.setFrequency(static_cast<float>(modulationRate * 1.1f)); // Slight detuning for stereo width
+    
+    // Full depth swings the modulated lines by FDNReverb::maxModulationMs
+    fdn.setModulationDepth(static_cast<float>(modulationDepth * FDNReverb::maxModulationMs * 0.001 * currentSampleRate));
 }
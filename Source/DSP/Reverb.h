@@ -2,10 +2,13 @@
 
 #include <juce_dsp/juce_dsp.h>
 #include "../Preset/PresetSchema.h"
+#include "FDNReverb.h"
+#include "ConvolutionReverb.h"
 
 /**
  * Multi-algorithm reverb processor
- * Supports Room, Plate, Hall, and Shimmer algorithms for wide sonic range
+ * Supports Room, Plate, Hall, and Shimmer algorithms for wide sonic range,
+ * plus Convolution for long sampled (or synthesized) impulse responses
  */
 class Reverb
 {
@@ -34,9 +37,20 @@ public:
     void setShimmerPitch(float semitones);  // -12 to +12 semitones
     void setShimmerMix(float mix);          // 0 to 1
     
+    // Impulse response for the Convolution algorithm (message thread). Without one,
+    // a response is synthesized from the decay and damping settings
+    void loadImpulseResponse(juce::AudioBuffer<float>&& impulse, double impulseSampleRate);
+    void clearImpulseResponse();
+    
+    // Offline rendering: the convolution waits for its worker rather than dropping late partitions
+    void setNonRealtime(bool isNonRealtime) { convolution.setNonRealtime(isNonRealtime); }
+    
     // Apply parameters from preset
     void applyParameters(const ReverbParams& params);
     
+    // Time for the output to die away after the input stops
+    double getTailLengthSeconds() const;
+    
 private:
     // Parameters
     bool enabled = true;
@@ -53,40 +67,32 @@ private:
     float shimmerMix = 0.3f;
     
     // DSP components
-    juce::dsp::Reverb juceReverb;
+    FDNReverb fdn;
+    ConvolutionReverb convolution;
     juce::dsp::DelayLine<float> preDelayLine;
     
-    // Shimmer effect components
-    juce::dsp::Oversampling<float> shimmerOversampler;
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::vector<std::complex<float>> fftBuffer;
-    juce::AudioBuffer<float> shimmerBuffer;
+    // Preallocated dry copy, sized for one prepared block
+    juce::AudioBuffer<float> dryBuffer;
     
-    // Modulation
+    // Modulation LFOs, run at control rate (one step per modulationInterval samples)
+    static constexpr int modulationInterval = 32;
     juce::dsp::Oscillator<float> lfoL, lfoR;
-    juce::dsp::DelayLine<float> modulationDelayL, modulationDelayR;
-    
-    // Filtering for damping
-    juce::dsp::IIR::Filter<float> dampingFilterL, dampingFilterR;
+    int samplesUntilModulationUpdate = 0;
     
     // Processing state
     double currentSampleRate = 44100.0;
     int currentNumChannels = 2;
+    int maxBlockSize = 512;
     bool isPrepared = false;
     
-    // Algorithm-specific processing
-    void processRoom(juce::AudioBuffer<float>& buffer);
-    void processPlate(juce::AudioBuffer<float>& buffer);
-    void processHall(juce::AudioBuffer<float>& buffer);
-    void processShimmer(juce::AudioBuffer<float>& buffer);
-    
-    // Shimmer effect helpers
-    void processShimmerEffect(juce::AudioBuffer<float>& buffer);
-    void pitchShift(juce::AudioBuffer<float>& buffer, float semitones);
+    // Processing stages, run on chunks of at most maxBlockSize samples
+    void processChunk(float* const* channels, int numChannels, int numSamples);
+    void processPreDelay(float* const* channels, int numChannels, int numSamples);
+    void processNetwork(float* const* channels, int numChannels, int numSamples);
+    void mixDryWet(float* const* channels, int numChannels, int numSamples);
     
     // Parameter updates
     void updateReverbParameters();
-    void updateDampingFilter();
     void updateModulation();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Reverb)
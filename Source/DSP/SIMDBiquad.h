@@ -0,0 +1,152 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cmath>
+
+/**
+ * Normalised biquad coefficients (a0 = 1) with the RBJ cookbook designs
+ * and the analytic magnitude response used to draw EQ curves
+ */
+struct BiquadCoefficients
+{
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+    static BiquadCoefficients identity() { return {}; }
+    static BiquadCoefficients silence() { return { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }; }
+
+    static BiquadCoefficients lowPass(double sampleRate, double frequency, double q)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        return normalise((1.0 - w.cosine) * 0.5, 1.0 - w.cosine, (1.0 - w.cosine) * 0.5,
+                         1.0 + w.alpha, -2.0 * w.cosine, 1.0 - w.alpha);
+    }
+
+    static BiquadCoefficients highPass(double sampleRate, double frequency, double q)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        return normalise((1.0 + w.cosine) * 0.5, -(1.0 + w.cosine), (1.0 + w.cosine) * 0.5,
+                         1.0 + w.alpha, -2.0 * w.cosine, 1.0 - w.alpha);
+    }
+
+    static BiquadCoefficients allPass(double sampleRate, double frequency, double q)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        return normalise(1.0 - w.alpha, -2.0 * w.cosine, 1.0 + w.alpha,
+                         1.0 + w.alpha, -2.0 * w.cosine, 1.0 - w.alpha);
+    }
+
+    // Constant 0 dB peak gain
+    static BiquadCoefficients bandPass(double sampleRate, double frequency, double q)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        return normalise(w.alpha, 0.0, -w.alpha, 1.0 + w.alpha, -2.0 * w.cosine, 1.0 - w.alpha);
+    }
+
+    static BiquadCoefficients peaking(double sampleRate, double frequency, double q, double gainDb)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        const double a = std::pow(10.0, gainDb / 40.0);
+        return normalise(1.0 + w.alpha * a, -2.0 * w.cosine, 1.0 - w.alpha * a,
+                         1.0 + w.alpha / a, -2.0 * w.cosine, 1.0 - w.alpha / a);
+    }
+
+    static BiquadCoefficients lowShelf(double sampleRate, double frequency, double q, double gainDb)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        const double a = std::pow(10.0, gainDb / 40.0);
+        const double k = 2.0 * std::sqrt(a) * w.alpha;
+        return normalise(a * ((a + 1.0) - (a - 1.0) * w.cosine + k), 2.0 * a * ((a - 1.0) - (a + 1.0) * w.cosine),
+                         a * ((a + 1.0) - (a - 1.0) * w.cosine - k),
+                         (a + 1.0) + (a - 1.0) * w.cosine + k, -2.0 * ((a - 1.0) + (a + 1.0) * w.cosine),
+                         (a + 1.0) + (a - 1.0) * w.cosine - k);
+    }
+
+    static BiquadCoefficients highShelf(double sampleRate, double frequency, double q, double gainDb)
+    {
+        const auto w = warp(sampleRate, frequency, q);
+        const double a = std::pow(10.0, gainDb / 40.0);
+        const double k = 2.0 * std::sqrt(a) * w.alpha;
+        return normalise(a * ((a + 1.0) + (a - 1.0) * w.cosine + k), -2.0 * a * ((a - 1.0) + (a + 1.0) * w.cosine),
+                         a * ((a + 1.0) + (a - 1.0) * w.cosine - k),
+                         (a + 1.0) - (a - 1.0) * w.cosine + k, 2.0 * ((a - 1.0) - (a + 1.0) * w.cosine),
+                         (a + 1.0) - (a - 1.0) * w.cosine - k);
+    }
+
+    // Same response scaled by a constant gain
+    BiquadCoefficients scaled(float gain) const
+    {
+        return { b0 * gain, b1 * gain, b2 * gain, a1, a2 };
+    }
+
+    // Magnitude response in dB at a normalised angular frequency (radians per sample)
+    double magnitudeDb(double omega) const
+    {
+        // In double throughout: at low frequencies the terms nearly cancel
+        const double n0 = b0, n1 = b1, n2 = b2, d1 = a1, d2 = a2;
+        const double c1 = std::cos(omega);
+        const double c2 = std::cos(2.0 * omega);
+        const double numerator = n0 * n0 + n1 * n1 + n2 * n2 + 2.0 * (n0 * n1 + n1 * n2) * c1 + 2.0 * n0 * n2 * c2;
+        const double denominator = 1.0 + d1 * d1 + d2 * d2 + 2.0 * (d1 + d1 * d2) * c1 + 2.0 * d2 * c2;
+        return 10.0 * std::log10(juce::jmax(numerator, 1.0e-20) / juce::jmax(denominator, 1.0e-20));
+    }
+
+private:
+    struct Warped { double cosine, alpha; };
+
+    static Warped warp(double sampleRate, double frequency, double q)
+    {
+        // Kept below Nyquist so every design stays stable
+        const double limited = juce::jlimit(1.0, sampleRate * 0.49, frequency);
+        const double omega = juce::MathConstants<double>::twoPi * limited / sampleRate;
+        return { std::cos(omega), std::sin(omega) / (2.0 * q) };
+    }
+
+    static BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        return { static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b2 / a0),
+                 static_cast<float>(a1 / a0), static_cast<float>(a2 / a0) };
+    }
+};
+
+/**
+ * A row of independent biquads advanced together, one lane per filter
+ * Coefficients and state are stored lane by lane in plain arrays, so the
+ * fixed-size loop in processSample compiles to a few vector instructions
+ * covering every lane. Lanes may run different filters on different inputs;
+ * a cascade is several rows applied in turn
+ */
+template <int Lanes>
+struct SIMDBiquad
+{
+    void setLane(int lane, const BiquadCoefficients& c) noexcept
+    {
+        b0[lane] = c.b0;
+        b1[lane] = c.b1;
+        b2[lane] = c.b2;
+        a1[lane] = c.a1;
+        a2[lane] = c.a2;
+    }
+
+    void reset() noexcept
+    {
+        s1.fill(0.0f);
+        s2.fill(0.0f);
+    }
+
+    // One sample for every lane, transposed direct form II; in and out may alias
+    void processSample(const float* in, float* out) noexcept
+    {
+        for (int lane = 0; lane < Lanes; ++lane)
+        {
+            const float x = in[lane];
+            const float y = b0[lane] * x + s1[lane];
+            s1[lane] = b1[lane] * x - a1[lane] * y + s2[lane];
+            s2[lane] = b2[lane] * x - a2[lane] * y;
+            out[lane] = y;
+        }
+    }
+
+    alignas(32) std::array<float, Lanes> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+    alignas(32) std::array<float, Lanes> s1 {}, s2 {};
+};
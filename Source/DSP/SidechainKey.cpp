@@ -0,0 +1,51 @@
+#include "SidechainKey.h"
+#include "../Utils/FastMath.h"
+
+SidechainKey::SidechainKey()
+{
+}
+
+SidechainKey::~SidechainKey()
+{
+}
+
+void SidechainKey::prepare(int maximumBlockSize)
+{
+    levelsDb.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), 0.0f);
+    setInput(nullptr, 0, 0);
+}
+
+void SidechainKey::setInput(const float* const* keyChannels, int numKeyChannels, int numKeySamples)
+{
+    channels = keyChannels;
+    numChannels = (keyChannels != nullptr) ? numKeyChannels : 0;
+
+    // Blocks longer than announced are keyed only as far as the analysis buffer
+    // reaches; stages fall back to their own detectors past that point
+    numSamples = juce::jmin(numKeySamples, static_cast<int>(levelsDb.size()));
+    levelsValid = false;
+}
+
+const float* SidechainKey::getLevelsDb()
+{
+    if (!levelsValid && isActive())
+    {
+        float* levels = levelsDb.data();
+
+        const float* first = channels[0];
+        for (int i = 0; i < numSamples; ++i)
+            levels[i] = std::abs(first[i]);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            const float* input = channels[channel];
+            for (int i = 0; i < numSamples; ++i)
+                levels[i] = juce::jmax(levels[i], std::abs(input[i]));
+        }
+
+        FastMath::gainToDecibels(levels, levels, numSamples);
+        levelsValid = true;
+    }
+
+    return levelsDb.data();
+}
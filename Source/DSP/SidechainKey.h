@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+ * External sidechain key shared by the dynamics stages
+ * Holds pointers straight into the host's sidechain channels, so routing a
+ * key costs no copy. The stereo-linked level is analysed the first time a
+ * stage asks for it in a block and every later stage reuses that result;
+ * with no key routed, stages get a null key and run their own detectors
+ */
+class SidechainKey
+{
+public:
+    SidechainKey();
+    ~SidechainKey();
+
+    void prepare(int maximumBlockSize);
+
+    // Audio thread, once per block: point at this block's key channels.
+    // Pass zero channels when the sidechain bus is disabled
+    void setInput(const float* const* keyChannels, int numKeyChannels, int numKeySamples);
+
+    bool isActive() const { return numChannels > 0; }
+    int getNumSamples() const { return numSamples; }
+    const float* getChannel(int channel) const { return channels[juce::jmin(channel, numChannels - 1)]; }
+
+    // Largest magnitude across the key channels per sample, in dB (-120 dB floor)
+    const float* getLevelsDb();
+
+private:
+    const float* const* channels = nullptr;
+    int numChannels = 0;
+    int numSamples = 0;
+
+    std::vector<float> levelsDb;
+    bool levelsValid = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SidechainKey)
+};
@@ -47,14 +47,31 @@ AIGuitarPluginAudioProcessorEditor::AIGuitarPluginAudioProcessorEditor (AIGuitar
     generateButton.onClick = [this] { generateButtonClicked(); };
     addAndMakeVisible(generateButton);
     
+    // Set up A/B morph controls
+    storeAButton.setButtonText("Store A");
+    storeAButton.onClick = [this] { storeMorphSlotClicked(AIGuitarPluginAudioProcessor::MorphSlotA); };
+    addAndMakeVisible(storeAButton);
+    
+    storeBButton.setButtonText("Store B");
+    storeBButton.onClick = [this] { storeMorphSlotClicked(AIGuitarPluginAudioProcessor::MorphSlotB); };
+    addAndMakeVisible(storeBButton);
+    
+    morphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    morphSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    addAndMakeVisible(morphSlider);
+    
     // Set up parameter attachments
     gainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getParameters(), "gain", gainSlider);
     toneAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getParameters(), "tone", toneSlider);
+    morphAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getParameters(), "morph", morphSlider);
+    
+    updateMorphControls();
     
     // Set size - smaller and simpler
-    setSize (500, 300);
+    setSize (500, 340);
 }
 
 AIGuitarPluginAudioProcessorEditor::~AIGuitarPluginAudioProcessorEditor()
@@ -86,6 +103,12 @@ void AIGuitarPluginAudioProcessorEditor::resized()
     auto buttonArea = aiArea.removeFromTop(30).reduced(10, 5);
     generateButton.setBounds(buttonArea);
     
+    // Morph area: A on the left, B on the right, the morph between them
+    auto morphArea = bounds.removeFromBottom(40).reduced(10, 5);
+    storeAButton.setBounds(morphArea.removeFromLeft(80));
+    storeBButton.setBounds(morphArea.removeFromRight(80));
+    morphSlider.setBounds(morphArea.reduced(10, 0));
+    
     // Sliders area
     auto sliderArea = bounds.reduced(20);
     auto sliderWidth = sliderArea.getWidth() / 2;
@@ -113,3 +136,20 @@ void AIGuitarPluginAudioProcessorEditor::generateButtonClicked()
         });
     }
 }
+
+void AIGuitarPluginAudioProcessorEditor::storeMorphSlotClicked(AIGuitarPluginAudioProcessor::MorphSlot slot)
+{
+    audioProcessor.storeMorphSlot(slot);
+    updateMorphControls();
+}
+
+void AIGuitarPluginAudioProcessorEditor::updateMorphControls()
+{
+    // The morph only does anything once both slots hold a preset
+    const bool slotAFilled = audioProcessor.isMorphSlotFilled(AIGuitarPluginAudioProcessor::MorphSlotA);
+    const bool slotBFilled = audioProcessor.isMorphSlotFilled(AIGuitarPluginAudioProcessor::MorphSlotB);
+    
+    storeAButton.setButtonText(slotAFilled ? "A (stored)" : "Store A");
+    storeBButton.setButtonText(slotBFilled ? "B (stored)" : "Store B");
+    morphSlider.setEnabled(slotAFilled && slotBFilled);
+}
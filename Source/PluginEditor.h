@@ -23,12 +23,19 @@ private:
     juce::TextButton generateButton;
     juce::Label gainLabel, toneLabel, titleLabel;
     
+    // A/B morph: store the preset in play into a slot, then morph between them
+    juce::TextButton storeAButton, storeBButton;
+    juce::Slider morphSlider;
+    
     // Parameter attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gainAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> toneAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> morphAttachment;
     
     // Event handlers
     void generateButtonClicked();
+    void storeMorphSlotClicked(AIGuitarPluginAudioProcessor::MorphSlot slot);
+    void updateMorphControls();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AIGuitarPluginAudioProcessorEditor)
 };
\ No newline at end of file
@@ -8,6 +8,7 @@ AIGuitarPluginAudioProcessor::AIGuitarPluginAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -15,6 +16,17 @@ AIGuitarPluginAudioProcessor::AIGuitarPluginAudioProcessor()
 #endif
       parameters(*this, nullptr, juce::Identifier("AIGuitarPlugin"), createParameterLayout())
 {
+    // Looked up once; the audio thread reads the values through these
+    for (int i = 0; i < numParamIDs; ++i)
+        continuousParameters[static_cast<size_t>(i)] = parameters.getRawParameterValue(paramInfo[static_cast<size_t>(i)].id);
+    
+    for (int i = 0; i < numDiscreteParameters; ++i)
+        discreteParameters[static_cast<size_t>(i)] = parameters.getRawParameterValue(discreteParameterIDs[i]);
+    
+    morphParameter = parameters.getRawParameterValue("morph");
+    
+    lastHostValues.fill(std::numeric_limits<float>::quiet_NaN());
+    lastDiscreteValues.fill(-1);
 }
 
 AIGuitarPluginAudioProcessor::~AIGuitarPluginAudioProcessor()
@@ -61,7 +73,7 @@ bool AIGuitarPluginAudioProcessor::isMidiEffect() const
 
 double AIGuitarPluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return dspChain.getTailLengthSeconds();
 }
 
 int AIGuitarPluginAudioProcessor::getNumPrograms()
@@ -94,11 +106,14 @@ void AIGuitarPluginAudioProcessor::changeProgramName (int index, const juce::Str
 //==============================================================================
 void AIGuitarPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Initialize DSP chain
+    // Initialize DSP chain; offline renders wait for the convolution reverb's worker
+    dspChain.setNonRealtime(isNonRealtime());
     dspChain.prepareToPlay(sampleRate, samplesPerBlock);
+    setLatencySamples(dspChain.getLatencyInSamples());
     
     // Initialize parameter smoother
     parameterSmoother.prepareToPlay(sampleRate, samplesPerBlock);
+    presetMorpher.prepareToPlay(sampleRate);
 }
 
 void AIGuitarPluginAudioProcessor::releaseResources()
@@ -124,6 +139,16 @@ bool AIGuitarPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The optional sidechain key may be off, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+        if (! sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -146,11 +171,55 @@ void AIGuitarPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     // Update DSP parameters from UI
     updateDSPFromParameters();
     
-    // Update smoothed parameters
+    // Read the host transport once per block for tempo-synced effects
+    if (auto* playHead = getPlayHead())
+    {
+        if (auto position = playHead->getPosition())
+        {
+            DSPChain::TransportState transport;
+            transport.bpm = position->getBpm().orFallback(120.0);
+            transport.ppqPosition = position->getPpqPosition().orFallback(0.0);
+            transport.isPlaying = position->getIsPlaying();
+            dspChain.setTransport(transport);
+        }
+    }
+    
+    // With A/B snapshots loaded, the morph position sets every continuous
+    // parameter; the drive crossfades between the two presets' curves
+    presetMorpher.process(morphParameter->load(), parameterSmoother, buffer.getNumSamples());
+    if (presetMorpher.isActive())
+    {
+        const auto blend = presetMorpher.getDriveBlend();
+        dspChain.setDriveCrossfade(blend.from, blend.to, blend.amount);
+        morphWasActive = true;
+    }
+    else if (morphWasActive)
+    {
+        // Once the morph lets go, the drive returns to the host's curve and
+        // every continuous parameter ramps back to its host value
+        dspChain.setDriveType(static_cast<DriveType>(lastDiscreteValues[DriveTypeChoice]));
+        
+        for (size_t i = 0; i < lastHostValues.size(); ++i)
+            parameterSmoother.setTargetValue(static_cast<ParamID>(i), lastHostValues[i]);
+        
+        morphWasActive = false;
+    }
+    
+    // Advance the smoothed parameters and render this block's ramps
     parameterSmoother.process(buffer.getNumSamples());
     
+    // Views onto this buffer's channels; nothing is copied. The sidechain view
+    // has to outlive dspChain.processBlock, which reads the key through it
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    auto* sidechainBus = getBus(true, 1);
+    const bool sidechainActive = sidechainBus != nullptr && sidechainBus->isEnabled();
+    auto sidechain = sidechainActive ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<float>();
+    
+    dspChain.setSidechainInput(sidechainActive ? sidechain.getArrayOfReadPointers() : nullptr,
+                               sidechain.getNumChannels(), sidechain.getNumSamples());
+    
     // Process audio through DSP chain
-    dspChain.processBlock(buffer);
+    dspChain.processBlock(mainBuffer, parameterSmoother);
 }
 
 //==============================================================================
@@ -167,8 +236,17 @@ juce::AudioProcessorEditor* AIGuitarPluginAudioProcessor::createEditor()
 //==============================================================================
 void AIGuitarPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Save parameters to memory block
+    // Save parameters to memory block, with the filled morph slots and the
+    // multiband block as preset JSON
     auto state = parameters.copyState();
+    
+    for (int i = 0; i < numMorphSlots; ++i)
+        if (morphSlotFilled[static_cast<size_t>(i)])
+            state.setProperty(morphSlotStateIDs[i], juce::JSON::toString(morphSlots[static_cast<size_t>(i)].toVar()), nullptr);
+    
+    if (multibandSettingsApplied)
+        state.setProperty(multibandStateID, juce::JSON::toString(multibandSettings.toVar()), nullptr);
+    
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
 }
@@ -178,9 +256,35 @@ void AIGuitarPluginAudioProcessor::setStateInformation (const void* data, int si
     // Restore parameters from memory block
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName (parameters.state.getType()))
-            parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+    if (xmlState.get() == nullptr || !xmlState->hasTagName (parameters.state.getType()))
+        return;
+    
+    auto state = juce::ValueTree::fromXml (*xmlState);
+    
+    // The morph slots and multiband block come back as they were saved; the
+    // parameter tree itself only keeps parameters
+    clearMorphPresets();
+    
+    if (state.hasProperty(multibandStateID))
+    {
+        multibandSettings.fromVar(juce::JSON::parse(state[multibandStateID].toString()));
+        multibandSettingsApplied = true;
+        state.removeProperty(multibandStateID, nullptr);
+        dspChain.setMultibandParameters(multibandSettings);
+    }
+    
+    for (int i = 0; i < numMorphSlots; ++i)
+    {
+        if (!state.hasProperty(morphSlotStateIDs[i]))
+            continue;
+        
+        PresetData preset;
+        preset.fromVar(juce::JSON::parse(state[morphSlotStateIDs[i]].toString()));
+        state.removeProperty(morphSlotStateIDs[i], nullptr);
+        loadMorphSlot(static_cast<MorphSlot>(i), preset);
+    }
+    
+    parameters.replaceState (state);
 }
 
 //==============================================================================
@@ -188,38 +292,223 @@ juce::AudioProcessorValueTreeState::ParameterLayout AIGuitarPluginAudioProcessor
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
     
-    // Add basic parameters for testing
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "gain", "Gain", 
-        juce::NormalisableRange<float>(0.0f, 2.0f, 0.01f), 1.0f));
-        
+    // Every continuous chain parameter, straight from the ParamID table
+    for (const auto& info : paramInfo)
+    {
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            info.id, info.name, 
+            juce::NormalisableRange<float>(info.minValue, info.maxValue), info.defaultValue));
+    }
+    
+    // Discrete settings, in DiscreteParameter order
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        discreteParameterIDs[DriveTypeChoice], "Drive Type", 
+        juce::StringArray { "Soft Clip", "Hard Clip", "Tube Screamer", "Fuzz" }, 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[GateEnabled], "Gate", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[MultibandEnabled], "Multiband", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[DelaySync], "Delay Sync", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        discreteParameterIDs[DelayDivisionChoice], "Delay Division", 
+        juce::StringArray { "1/1", "1/2", "1/4", "1/8", "1/16",
+                            "1/2 Dotted", "1/4 Dotted", "1/8 Dotted", "1/16 Dotted",
+                            "1/2 Triplet", "1/4 Triplet", "1/8 Triplet", "1/16 Triplet" },
+        static_cast<int>(NoteDivision::Quarter)));
+    
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        discreteParameterIDs[ChorusVoices], "Chorus Voices", 1, 8, 1));
+    
+    // Duck follows the sidechain key when one is routed, the input otherwise
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        discreteParameterIDs[GateModeChoice], "Gate Mode", 
+        juce::StringArray { "Gate", "Duck", "Rhythmic" }, 0));
+    
+    // Rhythmic pattern, one bit per step: steps 1 to 16, then 17 to 32 when
+    // the pattern runs in thirty-seconds. Smoothing and depth are percentages
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        discreteParameterIDs[GatePattern], "Gate Pattern", 0, 0xffff, 0x5555));
+    
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        discreteParameterIDs[GatePatternHigh], "Gate Pattern 17-32", 0, 0xffff, 0x5555));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        discreteParameterIDs[GateStepsChoice], "Gate Steps", 
+        juce::StringArray { "16", "32" }, 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        discreteParameterIDs[GateSmoothing], "Gate Smoothing", 0, 50, 10));
+    
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        discreteParameterIDs[GateDepth], "Gate Depth", 0, 100, 80));
+    
+    // The preset eq block's side of the drive, and whether the drive section
+    // runs oversampled; both follow the preset's chain
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        discreteParameterIDs[EqualizerPlacementChoice], "EQ Placement", 
+        juce::StringArray { "Off", "Before Drive", "After Drive" }, 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[DriveOversampling], "Drive Oversampling", true));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        discreteParameterIDs[ReverbAlgorithmChoice], "Reverb Algorithm", 
+        juce::StringArray { "Room", "Plate", "Hall", "Shimmer", "Convolution" },
+        static_cast<int>(ReverbAlgorithm::Plate)));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[CompressorEnabled], "Compressor", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[EqualizerMidDynamic], "EQ Dynamic Mid", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        discreteParameterIDs[EqualizerAnalog], "EQ Analog", true));
+    
+    // A/B preset morph position; unstepped so automation moves it smoothly
     layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "tone", "Tone", 
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f));
+        "morph", "Morph", 
+        juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
     
     return layout;
 }
 
-void AIGuitarPluginAudioProcessor::updateDSPFromParameters()
+void AIGuitarPluginAudioProcessor::setMorphPresets(const PresetData& presetA, const PresetData& presetB)
 {
-    // Update DSP chain from current parameter values
-    auto* gainParam = parameters.getRawParameterValue("gain");
-    auto* toneParam = parameters.getRawParameterValue("tone");
+    presetMorpher.setSnapshots(PresetMorpher::makeSnapshot(presetA), PresetMorpher::makeSnapshot(presetB));
+}
 
-    // Null checks for safety
-    if (gainParam != nullptr)
+void AIGuitarPluginAudioProcessor::clearMorphPresets()
+{
+    morphSlotFilled.fill(false);
+    presetMorpher.clearSnapshots();
+}
+
+void AIGuitarPluginAudioProcessor::storeMorphSlot(MorphSlot slot)
+{
+    loadMorphSlot(slot, presetManager.getCurrentPreset());
+}
+
+void AIGuitarPluginAudioProcessor::loadMorphSlot(MorphSlot slot, const PresetData& preset)
+{
+    morphSlots[slot] = preset;
+    morphSlotFilled[slot] = true;
+    
+    if (morphSlotFilled[MorphSlotA] && morphSlotFilled[MorphSlotB])
+        setMorphPresets(morphSlots[MorphSlotA], morphSlots[MorphSlotB]);
+}
+
+void AIGuitarPluginAudioProcessor::updateDSPFromParameters()
+{
+    // Only host changes are posted, so ramps already under way (from the
+    // morph, say) hold until the parameter itself moves
+    for (size_t i = 0; i < continuousParameters.size(); ++i)
     {
-        float gainValue = juce::jlimit(0.0f, 2.0f, *gainParam);
-        dspChain.setGain(gainValue);
+        const float value = continuousParameters[i]->load(std::memory_order_relaxed);
+        if (value != lastHostValues[i])
+        {
+            parameterSmoother.setTargetValue(static_cast<ParamID>(i), value);
+            lastHostValues[i] = value;
+        }
     }
+    
+    for (size_t i = 0; i < discreteParameters.size(); ++i)
+    {
+        const int value = juce::roundToInt(discreteParameters[i]->load(std::memory_order_relaxed));
+        if (value != lastDiscreteValues[i])
+        {
+            applyDiscreteParameter(static_cast<DiscreteParameter>(i), value);
+            lastDiscreteValues[i] = value;
+        }
+    }
+}
 
-    if (toneParam != nullptr)
+void AIGuitarPluginAudioProcessor::applyDiscreteParameter(DiscreteParameter parameter, int value)
+{
+    switch (parameter)
     {
-        float toneValue = juce::jlimit(0.0f, 1.0f, *toneParam);
-        dspChain.setTone(toneValue);
+        case DriveTypeChoice:
+            dspChain.setDriveType(static_cast<DriveType>(value));
+            break;
+        case GateEnabled:
+            dspChain.setGateEnabled(value != 0);
+            break;
+        case MultibandEnabled:
+            dspChain.setMultibandEnabled(value != 0);
+            break;
+        case DelaySync:
+            dspChain.setDelaySync(value != 0);
+            break;
+        case DelayDivisionChoice:
+            dspChain.setDelayDivision(static_cast<NoteDivision>(value));
+            break;
+        case ChorusVoices:
+            dspChain.setChorusVoices(value);
+            break;
+        case GateModeChoice:
+            dspChain.setGateMode(value);
+            break;
+        case GatePattern:
+        case GatePatternHigh:
+        case GateStepsChoice:
+        {
+            // The pattern's halves and step count go across together
+            auto discreteValue = [this](DiscreteParameter id)
+            {
+                return static_cast<juce::uint32>(juce::roundToInt(discreteParameters[id]->load(std::memory_order_relaxed)));
+            };
+            
+            dspChain.setGatePattern(discreteValue(GatePattern) | (discreteValue(GatePatternHigh) << 16),
+                                    discreteValue(GateStepsChoice) != 0 ? 32 : 16);
+            break;
+        }
+        case GateSmoothing:
+            dspChain.setGateSmoothing(value / 100.0f);
+            break;
+        case GateDepth:
+            dspChain.setGateDepth(value / 100.0f);
+            break;
+        case EqualizerPlacementChoice:
+            dspChain.setEqualizerPlacement(static_cast<DSPChain::EqualizerPlacement>(value));
+            break;
+        case DriveOversampling:
+            dspChain.setNonlinearOversampling(value != 0);
+            break;
+        case ReverbAlgorithmChoice:
+            dspChain.setReverbAlgorithm(static_cast<ReverbAlgorithm>(value));
+            break;
+        case CompressorEnabled:
+            dspChain.setCompressorEnabled(value != 0);
+            break;
+        case EqualizerMidDynamic:
+            dspChain.setEqualizerMidDynamic(value != 0);
+            break;
+        case EqualizerAnalog:
+            dspChain.setEqualizerAnalogModeling(value != 0);
+            break;
+        default:
+            break;
     }
 }
 
+void AIGuitarPluginAudioProcessor::setHostParameter(const juce::String& parameterID, float value)
+{
+    // Message thread. The host is told of the change, the value is saved with
+    // the state, and the audio thread picks it up at its next block
+    if (auto* parameter = parameters.getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+void AIGuitarPluginAudioProcessor::setHostParameter(ParamID paramId, float value)
+{
+    setHostParameter(getParamInfo(paramId).id, value);
+}
+
 // Helper class for thread pool jobs
 class PresetGenerationJob : public juce::ThreadPoolJob
 {
@@ -402,245 +691,177 @@ void AIGuitarPluginAudioProcessor::applyPresetFromJson(const juce::var& presetJs
         {
             DBG("Found chain with " + juce::String(chain.size()) + " blocks");
             
-            // Apply preset based on description and enabled blocks
-            // This is a simplified implementation that maps presets to gain/tone values
-            
-            float gainValue = 1.0f;
-            float toneValue = 0.5f;
-            
-            // Extract preset name for mapping
-            auto presetName = presetJson["name"];
-            juce::String name = presetName.toString().toLowerCase();
+            // The continuous parameters and drive curve come from the same
+            // snapshot an A/B morph slot takes, so a morph end sounds like the
+            // preset applied on its own
+            PresetData appliedPreset;
+            appliedPreset.fromVar(presetJson);
+            const auto snapshot = PresetMorpher::makeSnapshot(appliedPreset);
             
-            DBG("Applying preset: " + name);
+            // Noise gate follows the preset's own block
+            bool gateEnabled = false;
+            NoiseGateParams gateBlock;
             
-            // Map preset types to gain/tone values
-            if (name.contains("heavy") || name.contains("metal") || name.contains("distorted"))
-            {
-                gainValue = 1.8f;  // High gain
-                toneValue = 0.3f;  // Darker tone
-                DBG("Applied heavy/metal preset mapping");
-            }
-            else if (name.contains("clean") || name.contains("ambient"))
+            for (int i = 0; i < chain.size(); ++i)
             {
-                gainValue = 0.3f;  // Low gain
-                toneValue = 0.7f;  // Bright tone
-                DBG("Applied clean/ambient preset mapping");
-            }
-            else if (name.contains("alien") || name.contains("ethereal") || name.contains("weird"))
-            {
-                gainValue = 1.5f;  // Medium-high gain
-                toneValue = 0.8f;  // Very bright tone
-                DBG("Applied alien/ethereal preset mapping");
+                auto block = chain[i];
+                if (block.isObject() && block["block"].toString() == "noise_gate")
+                {
+                    auto enabled = block["enabled"];
+                    gateEnabled = enabled.isBool() && static_cast<bool>(enabled);
+                    gateBlock.fromVar(block);
+                    break;
+                }
             }
-            else if (name.contains("blues") || name.contains("crunch"))
+            
+            // Multiband dynamics takes the preset's bands and crossovers, or its
+            // built-in low-end tightening when the block leaves them out
+            bool multibandEnabled = false;
+            MultibandDynamicsParams multibandBlock;
+            
+            for (int i = 0; i < chain.size(); ++i)
             {
-                gainValue = 1.2f;  // Medium gain
-                toneValue = 0.4f;  // Warm tone
-                DBG("Applied blues/crunch preset mapping");
+                auto block = chain[i];
+                if (block.isObject() && block["block"].toString() == "multiband")
+                {
+                    auto enabled = block["enabled"];
+                    multibandEnabled = enabled.isBool() && static_cast<bool>(enabled);
+                    multibandBlock.fromVar(block);
+                    break;
+                }
             }
-            else
+            
+            // The compressor block runs ahead of the drive
+            bool compressorEnabled = false;
+            
+            for (int i = 0; i < chain.size(); ++i)
             {
-                // Default mapping based on enabled blocks
-                bool hasDrive = false;
-                bool hasReverb = false;
-                bool hasDelay = false;
-                
-                for (int i = 0; i < chain.size(); ++i)
+                auto block = chain[i];
+                if (block.isObject() && block["block"].toString() == "compressor")
                 {
-                    auto block = chain[i];
-                    if (block.isObject())
-                    {
-                        auto blockType = block["block"].toString();
-                        auto enabled = block["enabled"];
-                        
-                        if (enabled.isBool() && static_cast<bool>(enabled))
-                        {
-                            if (blockType == "drive") hasDrive = true;
-                            if (blockType == "reverb") hasReverb = true;
-                            if (blockType == "delay") hasDelay = true;
-                        }
-                    }
+                    auto enabled = block["enabled"];
+                    compressorEnabled = enabled.isBool() && static_cast<bool>(enabled);
+                    break;
                 }
-                
-                // Apply logic based on enabled effects
-                if (hasDrive)
+            }
+            
+            // The reverb block picks the algorithm
+            ReverbParams reverbBlock;
+            
+            for (int i = 0; i < chain.size(); ++i)
+            {
+                auto block = chain[i];
+                if (block.isObject() && block["block"].toString() == "reverb")
                 {
-                    gainValue = 1.4f;  // Higher gain when drive is enabled
-                    toneValue = 0.4f;  // Slightly darker
+                    reverbBlock.fromVar(block);
+                    break;
                 }
-                if (hasReverb || hasDelay)
+            }
+            
+            // A tempo-synced delay block hands its division to the host tempo
+            DelayParams delayBlock;
+            
+            for (int i = 0; i < chain.size(); ++i)
+            {
+                auto block = chain[i];
+                if (block.isObject() && block["block"].toString() == "delay")
                 {
-                    toneValue = juce::jmax(toneValue, 0.6f);  // Brighter when reverb/delay
+                    delayBlock.fromVar(block);
+                    break;
                 }
-                
-                DBG("Applied block-based preset mapping - Drive: " + juce::String(hasDrive) + 
-                    ", Reverb: " + juce::String(hasReverb) + ", Delay: " + juce::String(hasDelay));
             }
             
-            // Apply the parameters with smoothing
-            parameterSmoother.setTargetValue("gain", gainValue);
-            parameterSmoother.setTargetValue("tone", toneValue);
-            
-            // Apply additional DSP parameters directly to the DSP chain
-            // (These don't use the parameter system yet, so we set them directly)
+            const bool delaySync = delayBlock.enabled && delayBlock.tempoSync;
             
-            // Set drive based on preset type
-            float driveValue = 0.0f;
-            juce::String driveType = "softclip";
+            // The chorus block's voice count: 1 is the classic chorus, 3 to 8 an ensemble
+            ChorusParams chorusBlock;
             
-            if (name.contains("heavy") || name.contains("metal") || name.contains("distorted"))
+            for (int i = 0; i < chain.size(); ++i)
             {
-                driveValue = 0.8f;  // High drive
-                driveType = "hardclip";
-            }
-            else if (name.contains("alien") || name.contains("ethereal") || name.contains("weird"))
-            {
-                driveValue = 0.6f;  // Medium drive
-                driveType = "fuzz";
-            }
-            else if (name.contains("blues") || name.contains("crunch"))
-            {
-                driveValue = 0.4f;  // Light drive
-                driveType = "softclip";
-            }
-            else
-            {
-                // Check if drive is enabled in the preset
-                bool presetHasDrive = false;
-                for (int i = 0; i < chain.size(); ++i)
-                {
-                    auto block = chain[i];
-                    if (block.isObject())
-                    {
-                        auto blockType = block["block"].toString();
-                        auto enabled = block["enabled"];
-                        if (blockType == "drive" && enabled.isBool() && static_cast<bool>(enabled))
-                        {
-                            presetHasDrive = true;
-                            break;
-                        }
-                    }
-                }
-                
-                if (presetHasDrive)
+                auto block = chain[i];
+                if (block.isObject() && block["block"].toString() == "chorus")
                 {
-                    driveValue = 0.5f;  // Default drive
-                    driveType = "softclip";
+                    chorusBlock.fromVar(block);
+                    break;
                 }
             }
             
-            // Set reverb based on preset type
-            float reverbMix = 0.0f;
-            float reverbDecay = 0.5f;
+            // An eq block runs next to the drive, on the side the chain puts it;
+            // the drive's oversample setting covers the whole drive section
+            auto eqPlacement = DSPChain::EqualizerPlacement::Off;
+            bool nonlinearOversampling = true;
+            int driveIndex = -1;
+            int eqIndex = -1;
+            EqualizerParams eqBlock;
             
-            if (name.contains("ambient") || name.contains("ethereal") || name.contains("space"))
-            {
-                reverbMix = 0.4f;    // High reverb
-                reverbDecay = 0.8f;  // Long decay
-            }
-            else if (name.contains("alien") || name.contains("weird"))
-            {
-                reverbMix = 0.3f;    // Medium reverb
-                reverbDecay = 0.9f;  // Very long decay
-            }
-            else
+            for (int i = 0; i < chain.size(); ++i)
             {
-                // Check if reverb is enabled in the preset
-                bool presetHasReverb = false;
-                for (int i = 0; i < chain.size(); ++i)
+                auto block = chain[i];
+                if (!block.isObject())
+                    continue;
+                
+                auto blockType = block["block"].toString();
+                auto enabled = block["enabled"];
+                
+                if (blockType == "drive" && driveIndex < 0)
                 {
-                    auto block = chain[i];
-                    if (block.isObject())
-                    {
-                        auto blockType = block["block"].toString();
-                        auto enabled = block["enabled"];
-                        if (blockType == "reverb" && enabled.isBool() && static_cast<bool>(enabled))
-                        {
-                            presetHasReverb = true;
-                            break;
-                        }
-                    }
+                    driveIndex = i;
+                    
+                    auto oversample = block["params"]["oversample"];
+                    if (!oversample.isVoid())
+                        nonlinearOversampling = static_cast<int>(oversample) > 1;
                 }
-                
-                if (presetHasReverb)
+                else if (blockType == "eq" && eqIndex < 0 && enabled.isBool() && static_cast<bool>(enabled))
                 {
-                    reverbMix = 0.2f;    // Light reverb
-                    reverbDecay = 0.6f;  // Medium decay
+                    eqIndex = i;
+                    eqBlock.fromVar(block);
                 }
             }
             
-            // Set delay and chorus based on preset type
-            float delayMix = 0.0f;
-            float delayTime = 0.25f;
-            float chorusMix = 0.0f;
-            float chorusRate = 0.5f;
+            if (eqIndex >= 0)
+                eqPlacement = (driveIndex >= 0 && driveIndex < eqIndex) ? DSPChain::EqualizerPlacement::AfterDrive
+                                                                        : DSPChain::EqualizerPlacement::BeforeDrive;
             
-            if (name.contains("space") || name.contains("echo") || name.contains("delay"))
-            {
-                delayMix = 0.3f;
-                delayTime = 0.5f;
-            }
-            else if (name.contains("alien") || name.contains("weird"))
-            {
-                delayMix = 0.2f;
-                delayTime = 0.75f;
-                chorusMix = 0.4f;
-                chorusRate = 1.5f;
-            }
-            else if (name.contains("ambient") || name.contains("ethereal"))
-            {
-                delayMix = 0.25f;
-                delayTime = 0.6f;
-                chorusMix = 0.3f;
-                chorusRate = 0.8f;
-            }
+            // Apply all the new parameters
+            multibandSettings = multibandBlock;
+            multibandSettingsApplied = true;
+            dspChain.setMultibandParameters(multibandSettings);
+            setHostParameter(discreteParameterIDs[GateEnabled], gateEnabled ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[MultibandEnabled], multibandEnabled ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[DriveTypeChoice], static_cast<float>(snapshot.driveType));
+            setHostParameter(discreteParameterIDs[DelaySync], delaySync ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[DelayDivisionChoice], static_cast<float>(delayBlock.division));
+            setHostParameter(discreteParameterIDs[ChorusVoices], static_cast<float>(chorusBlock.voices));
+            setHostParameter(discreteParameterIDs[GateModeChoice], static_cast<float>(gateBlock.mode));
+            setHostParameter(discreteParameterIDs[GatePattern], static_cast<float>(gateBlock.pattern & 0xffffu));
+            setHostParameter(discreteParameterIDs[GatePatternHigh], static_cast<float>(gateBlock.pattern >> 16));
+            setHostParameter(discreteParameterIDs[GateStepsChoice], gateBlock.steps == 32 ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[GateSmoothing], gateBlock.smoothing * 100.0f);
+            setHostParameter(discreteParameterIDs[GateDepth], gateBlock.depth * 100.0f);
+            setHostParameter(discreteParameterIDs[EqualizerPlacementChoice], static_cast<float>(eqPlacement));
+            setHostParameter(discreteParameterIDs[DriveOversampling], nonlinearOversampling ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[ReverbAlgorithmChoice], static_cast<float>(reverbBlock.algorithm));
+            setHostParameter(discreteParameterIDs[CompressorEnabled], compressorEnabled ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[EqualizerMidDynamic], eqBlock.midDynamic ? 1.0f : 0.0f);
+            setHostParameter(discreteParameterIDs[EqualizerAnalog], eqBlock.analogModeling ? 1.0f : 0.0f);
             
-            // Set EQ based on preset type
-            float eqHigh = 0.5f;
-            float eqMid = 0.5f;
-            float eqLow = 0.5f;
+            for (int i = 0; i < numParamIDs; ++i)
+                setHostParameter(static_cast<ParamID>(i), snapshot.values[static_cast<size_t>(i)]);
             
-            if (name.contains("bright") || name.contains("crisp") || name.contains("shimmer"))
-            {
-                eqHigh = 0.8f;
-                eqMid = 0.6f;
-            }
-            else if (name.contains("warm") || name.contains("dark") || name.contains("mellow"))
-            {
-                eqHigh = 0.3f;
-                eqLow = 0.8f;
-            }
-            else if (name.contains("alien") || name.contains("weird"))
-            {
-                eqHigh = 0.9f;
-                eqMid = 0.3f;
-                eqLow = 0.7f;
-            }
-            
-            // Apply all the new parameters
-            dspChain.setDrive(driveValue);
-            dspChain.setDriveType(driveType);
-            dspChain.setReverbMix(reverbMix);
-            dspChain.setReverbDecay(reverbDecay);
-            dspChain.setDelayMix(delayMix);
-            dspChain.setDelayTime(delayTime);
-            dspChain.setChorusMix(chorusMix);
-            dspChain.setChorusRate(chorusRate);
-            dspChain.setEQHigh(eqHigh);
-            dspChain.setEQMid(eqMid);
-            dspChain.setEQLow(eqLow);
+            // Kept as the preset in play, for an A/B slot to store
+            presetManager.setCurrentPreset(appliedPreset);
             
                     // Show success message (simplified to prevent crashes)
                     DBG("AI Preset Applied Successfully: " + description);
-                    DBG("Gain: " + juce::String(gainValue, 2) + ", Tone: " + juce::String(toneValue, 2));
-                    DBG("Drive: " + juce::String(driveValue, 2) + " (" + driveType + ")");
-                    DBG("Reverb: " + juce::String(reverbMix, 2) + " mix, " + juce::String(reverbDecay, 2) + " decay");
-                    DBG("Delay: " + juce::String(delayMix, 2) + " mix, " + juce::String(delayTime, 2) + " time");
-                    DBG("Chorus: " + juce::String(chorusMix, 2) + " mix, " + juce::String(chorusRate, 2) + " rate");
-                    DBG("EQ: H=" + juce::String(eqHigh, 2) + " M=" + juce::String(eqMid, 2) + " L=" + juce::String(eqLow, 2));
+                    DBG("Drive type: " + driveTypeToString(snapshot.driveType)
+                        + (delaySync ? ", delay synced to " + noteDivisionToString(delayBlock.division) : juce::String()));
+                    
+                    for (int i = 0; i < numParamIDs; ++i)
+                    {
+                        DBG(juce::String(paramInfo[static_cast<size_t>(i)].name) + ": "
+                            + juce::String(snapshot.values[static_cast<size_t>(i)], 2));
+                    }
                 
-            DBG("Successfully applied preset - Gain: " + juce::String(gainValue) + ", Tone: " + juce::String(toneValue));
         }
                 else
                 {
@@ -4,6 +4,7 @@
 #include <juce_dsp/juce_dsp.h>
 #include "DSP/DSPChain.h"
 #include "Preset/PresetManager.h"
+#include "Preset/PresetMorpher.h"
 #include "Utils/ParameterSmoother.h"
 
 class AIGuitarPluginAudioProcessor : public juce::AudioProcessor
@@ -47,6 +48,18 @@ public:
             void cancelPresetGeneration();
             void applyPresetFromJson(const juce::var& presetJson, const juce::String& description);
     
+    // A/B morphing: the "morph" parameter moves between the two presets
+    // (message thread)
+    void setMorphPresets(const PresetData& presetA, const PresetData& presetB);
+    void clearMorphPresets();
+    
+    // A/B slots: storing the preset in play, or loading one, fills a slot;
+    // once both hold a preset the morph runs between them
+    enum MorphSlot { MorphSlotA, MorphSlotB, numMorphSlots };
+    void storeMorphSlot(MorphSlot slot);
+    void loadMorphSlot(MorphSlot slot, const PresetData& preset);
+    bool isMorphSlotFilled(MorphSlot slot) const { return morphSlotFilled[slot]; }
+    
     // Parameter access
     juce::AudioProcessorValueTreeState& getParameters() { return parameters; }
     
@@ -67,10 +80,64 @@ private:
     // DSP components
     DSPChain dspChain;
     ParameterSmoother parameterSmoother;
+    PresetMorpher presetMorpher;
+
+    // Host parameters that aren't in the ParamID table
+    enum DiscreteParameter
+    {
+        DriveTypeChoice,
+        GateEnabled,
+        MultibandEnabled,
+        DelaySync,
+        DelayDivisionChoice,
+        ChorusVoices,
+        GateModeChoice,
+        GatePattern,
+        GatePatternHigh,
+        GateStepsChoice,
+        GateSmoothing,
+        GateDepth,
+        EqualizerPlacementChoice,
+        DriveOversampling,
+        ReverbAlgorithmChoice,
+        CompressorEnabled,
+        EqualizerMidDynamic,
+        EqualizerAnalog,
+        numDiscreteParameters
+    };
+
+    static constexpr const char* discreteParameterIDs[numDiscreteParameters] {
+        "drive_type", "gate_enabled", "multiband_enabled", "delay_sync", "delay_division",
+        "chorus_voices", "gate_mode", "gate_pattern", "gate_pattern_high", "gate_steps",
+        "gate_smoothing", "gate_depth", "eq_placement", "drive_oversampling", "reverb_algorithm",
+        "compressor_enabled", "eq_mid_dynamic", "eq_analog"
+    };
+
+    // Raw values cached at construction, with the last of each seen by the
+    // audio thread
+    std::array<std::atomic<float>*, numParamIDs> continuousParameters {};
+    std::array<std::atomic<float>*, numDiscreteParameters> discreteParameters {};
+    std::atomic<float>* morphParameter = nullptr;
+    ParameterValues lastHostValues {};
+    std::array<int, numDiscreteParameters> lastDiscreteValues {};
+    bool morphWasActive = false;
 
     // Preset management
     PresetManager presetManager;
 
+    // The A/B morph presets, saved with the state as preset JSON
+    std::array<PresetData, numMorphSlots> morphSlots;
+    std::array<bool, numMorphSlots> morphSlotFilled {};
+
+    static constexpr const char* morphSlotStateIDs[numMorphSlots] { "morph_slot_a", "morph_slot_b" };
+
+    // The last preset's multiband bands and crossovers, which are not host
+    // parameters, saved with the state the same way
+    MultibandDynamicsParams multibandSettings;
+    bool multibandSettingsApplied = false;
+
+    static constexpr const char* multibandStateID = "multiband_block";
+
     // Thread pool for AI requests (max 2 concurrent requests)
     juce::ThreadPool threadPool{2};
 
@@ -80,6 +147,9 @@ private:
     // Parameter creation
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     void updateDSPFromParameters();
+    void applyDiscreteParameter(DiscreteParameter parameter, int value);
+    void setHostParameter(const juce::String& parameterID, float value);
+    void setHostParameter(ParamID paramId, float value);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AIGuitarPluginAudioProcessor)
 };
@@ -0,0 +1,220 @@
+#include "PresetMorpher.h"
+
+namespace
+{
+    void setValue(ParameterValues& values, ParamID id, float value)
+    {
+        values[static_cast<size_t>(id)] = value;
+    }
+}
+
+PresetMorpher::PresetMorpher()
+{
+}
+
+PresetMorpher::~PresetMorpher()
+{
+}
+
+PresetMorpher::Snapshot PresetMorpher::makeSnapshot(const PresetData& preset)
+{
+    Snapshot snapshot;
+    
+    for (int i = 0; i < numParamIDs; ++i)
+        snapshot.values[static_cast<size_t>(i)] = paramInfo[static_cast<size_t>(i)].defaultValue;
+    
+    // Effects the preset doesn't run contribute nothing to the mix
+    setValue(snapshot.values, ParamID::Drive, 0.0f);
+    setValue(snapshot.values, ParamID::ReverbMix, 0.0f);
+    setValue(snapshot.values, ParamID::DelayMix, 0.0f);
+    setValue(snapshot.values, ParamID::ChorusMix, 0.0f);
+    
+    // The first enabled block of each type sets its parameters, mapped onto
+    // the ranges DSPChain reads them in
+    std::array<bool, static_cast<size_t>(EffectBlockType::MultibandDynamics) + 1> seen {};
+    
+    for (const auto& block : preset.chain)
+    {
+        if (block == nullptr || ! block->enabled)
+            continue;
+    
+        const auto typeIndex = static_cast<size_t>(block->type);
+        if (typeIndex >= seen.size() || seen[typeIndex])
+            continue;
+    
+        seen[typeIndex] = true;
+    
+        switch (block->type)
+        {
+            case EffectBlockType::NoiseGate:
+            {
+                const auto& gate = static_cast<const NoiseGateParams&>(*block);
+                setValue(snapshot.values, ParamID::GateThreshold, juce::jlimit(-90.0f, 0.0f, gate.thresholdDb));
+                break;
+            }
+            case EffectBlockType::Compressor:
+            {
+                const auto& compressor = static_cast<const CompressorParams&>(*block);
+                setValue(snapshot.values, ParamID::CompressorRatio, juce::jlimit(1.0f, 10.0f, compressor.ratio));
+                setValue(snapshot.values, ParamID::CompressorThreshold, juce::jlimit(-60.0f, 0.0f, compressor.thresholdDb));
+                setValue(snapshot.values, ParamID::CompressorAttack, juce::jlimit(0.1f, 50.0f, compressor.attackMs));
+                setValue(snapshot.values, ParamID::CompressorRelease, juce::jlimit(10.0f, 500.0f, compressor.releaseMs));
+                setValue(snapshot.values, ParamID::CompressorMakeup, juce::jlimit(-12.0f, 12.0f, compressor.makeupDb));
+                break;
+            }
+            case EffectBlockType::Drive:
+            {
+                const auto& drive = static_cast<const DriveParams&>(*block);
+                setValue(snapshot.values, ParamID::Drive, juce::jlimit(0.0f, 1.0f, drive.drive));
+                setValue(snapshot.values, ParamID::Tone, juce::jlimit(0.0f, 1.0f, drive.tone));
+                snapshot.driveType = drive.driveType;
+                break;
+            }
+            case EffectBlockType::Amp:
+            {
+                const auto& amp = static_cast<const AmpParams&>(*block);
+                setValue(snapshot.values, ParamID::Gain, juce::jlimit(0.0f, 2.0f, amp.gain * 2.0f));
+                break;
+            }
+            case EffectBlockType::Cabinet:
+            {
+                // The cabinet's cuts become the chain's high-pass and low-pass
+                const auto& cabinet = static_cast<const CabinetParams&>(*block);
+                setValue(snapshot.values, ParamID::EQLow, juce::jlimit(0.0f, 1.0f, (cabinet.loCutHz - 20.0f) / 2000.0f));
+                setValue(snapshot.values, ParamID::EQHigh, juce::jlimit(0.0f, 1.0f, (cabinet.hiCutHz - 2000.0f) / 18000.0f));
+                break;
+            }
+            case EffectBlockType::Equalizer:
+            {
+                const auto& eq = static_cast<const EqualizerParams&>(*block);
+                // The mid gain goes to the Equalizer alone, not the chain's own mid filter as well
+                setValue(snapshot.values, ParamID::EQLowShelfFreq, juce::jlimit(60.0f, 200.0f, eq.lowShelfHz));
+                setValue(snapshot.values, ParamID::EQLowShelfGain, juce::jlimit(-12.0f, 12.0f, eq.lowGainDb));
+                setValue(snapshot.values, ParamID::EQMidFreq, juce::jlimit(300.0f, 5000.0f, eq.midHz));
+                setValue(snapshot.values, ParamID::EQMidQ, juce::jlimit(0.3f, 4.0f, eq.midQ));
+                setValue(snapshot.values, ParamID::EQMidGain, juce::jlimit(-12.0f, 12.0f, eq.midGainDb));
+                setValue(snapshot.values, ParamID::EQHighShelfFreq, juce::jlimit(4000.0f, 10000.0f, eq.highShelfHz));
+                setValue(snapshot.values, ParamID::EQHighShelfGain, juce::jlimit(-12.0f, 12.0f, eq.highGainDb));
+                setValue(snapshot.values, ParamID::EQDynamicThreshold, juce::jlimit(-60.0f, 0.0f, eq.midDynamicThresholdDb));
+                setValue(snapshot.values, ParamID::EQDynamicRange, juce::jlimit(0.0f, 18.0f, eq.midDynamicRangeDb));
+                break;
+            }
+            case EffectBlockType::Chorus:
+            {
+                const auto& chorus = static_cast<const ChorusParams&>(*block);
+                setValue(snapshot.values, ParamID::ChorusMix, juce::jlimit(0.0f, 1.0f, chorus.mix));
+                setValue(snapshot.values, ParamID::ChorusRate, juce::jlimit(0.1f, 5.0f, chorus.rateHz));
+                break;
+            }
+            case EffectBlockType::Delay:
+            {
+                const auto& delay = static_cast<const DelayParams&>(*block);
+                setValue(snapshot.values, ParamID::DelayMix, juce::jlimit(0.0f, 1.0f, delay.mix));
+                setValue(snapshot.values, ParamID::DelayTime, juce::jlimit(0.0f, 2.0f, delay.timeMs / 1000.0f));
+                break;
+            }
+            case EffectBlockType::Reverb:
+            {
+                const auto& reverb = static_cast<const ReverbParams&>(*block);
+                setValue(snapshot.values, ParamID::ReverbMix, juce::jlimit(0.0f, 1.0f, reverb.mix));
+                setValue(snapshot.values, ParamID::ReverbDecay, juce::jlimit(0.0f, 1.0f, (reverb.decayS - 0.2f) / 11.8f));
+                setValue(snapshot.values, ParamID::ReverbPreDelay, juce::jlimit(0.0f, 60.0f, reverb.preDelayMs));
+                setValue(snapshot.values, ParamID::ReverbDamping, juce::jlimit(0.0f, 1.0f, reverb.damping));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    
+    return snapshot;
+}
+
+void PresetMorpher::setSnapshots(const Snapshot& a, const Snapshot& b)
+{
+    const juce::SpinLock::ScopedLockType lock(pendingLock);
+    pendingA = a;
+    pendingB = b;
+    pendingActive = true;
+    hasPending.store(true, std::memory_order_release);
+}
+
+void PresetMorpher::clearSnapshots()
+{
+    const juce::SpinLock::ScopedLockType lock(pendingLock);
+    pendingActive = false;
+    hasPending.store(true, std::memory_order_release);
+}
+
+void PresetMorpher::prepareToPlay(double sampleRate)
+{
+    currentSampleRate = sampleRate;
+    reset();
+}
+
+void PresetMorpher::reset()
+{
+    // Forces the next block to post its targets again
+    lastMorph = -1.0f;
+}
+
+void PresetMorpher::applyPendingSnapshots()
+{
+    // If the message thread holds the lock, the snapshots are taken next block
+    const juce::SpinLock::ScopedTryLockType lock(pendingLock);
+    if (! lock.isLocked())
+        return;
+    
+    hasPending.store(false, std::memory_order_relaxed);
+    active = pendingActive;
+    
+    if (! active)
+    {
+        driveBlend = {};
+        return;
+    }
+    
+    for (size_t i = 0; i < origin.size(); ++i)
+    {
+        origin[i] = pendingA.values[i];
+        difference[i] = pendingB.values[i] - pendingA.values[i];
+    }
+    
+    driveBlend.from = pendingA.driveType;
+    driveBlend.to = pendingB.driveType;
+    lastMorph = -1.0f;
+}
+
+void PresetMorpher::process(float morph, ParameterSmoother& smoother, int numSamples)
+{
+    if (hasPending.load(std::memory_order_acquire))
+        applyPendingSnapshots();
+    
+    if (! active || numSamples <= 0)
+        return;
+    
+    morph = juce::jlimit(0.0f, 1.0f, morph);
+    if (morph == lastMorph)
+        return;
+    
+    lastMorph = morph;
+    
+    for (size_t i = 0; i < morphed.size(); ++i)
+        morphed[i] = origin[i] + morph * difference[i];
+    
+    // Each parameter ramps from where it is to the new position over this
+    // block, along its own curve
+    smoother.beginPresetTransition(static_cast<float>(numSamples / currentSampleRate));
+    smoother.setAllTargetValues(morphed);
+    smoother.endPresetTransition();
+    
+    if (driveBlend.from != driveBlend.to)
+    {
+        const float position = juce::jlimit(0.0f, 1.0f, (morph - driveCrossfadeStart) / driveCrossfadeWidth);
+        driveBlend.amount = position * position * (3.0f - 2.0f * position);
+    }
+    else
+    {
+        driveBlend.amount = 0.0f;
+    }
+}
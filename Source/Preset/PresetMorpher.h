@@ -0,0 +1,82 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "PresetSchema.h"
+#include "../Utils/ParameterIDs.h"
+#include "../Utils/ParameterSmoother.h"
+
+/**
+ * A/B morph between two presets under a single morph control
+ * Each preset is reduced to a snapshot of the chain's continuous parameters,
+ * and every block the morph position interpolates between the two and hands
+ * the result to the ParameterSmoother as one preset transition lasting the
+ * block, so the knob can be automated as fast as the host sends it.
+ * Interpolation is one multiply-add per parameter and is skipped while the
+ * knob rests. The drive type cannot be interpolated; around the middle of
+ * the range the drive crossfades from A's curve to B's instead
+ */
+class PresetMorpher
+{
+public:
+    struct Snapshot
+    {
+        ParameterValues values {};
+        DriveType driveType = DriveType::SoftClip;
+    };
+    
+    // The drive curves in play and how far the second is mixed in, 0 to 1
+    struct DriveBlend
+    {
+        DriveType from = DriveType::SoftClip;
+        DriveType to = DriveType::SoftClip;
+        float amount = 0.0f;
+    };
+    
+    PresetMorpher();
+    ~PresetMorpher();
+    
+    // Reads a preset's blocks into the chain's parameters, both for applying a
+    // preset and for a morph slot; blocks the preset leaves out or disables
+    // give the parameter's default, or silence for mixes
+    static Snapshot makeSnapshot(const PresetData& preset);
+    
+    // Message thread; the audio thread picks the snapshots up at its next block
+    void setSnapshots(const Snapshot& a, const Snapshot& b);
+    void clearSnapshots();
+    
+    // Setup
+    void prepareToPlay(double sampleRate);
+    void reset();
+    
+    // Audio thread, before the smoother's process(). Does nothing until
+    // snapshots are set; after that the morph owns every continuous parameter
+    void process(float morph, ParameterSmoother& smoother, int numSamples);
+    
+    bool isActive() const { return active; }
+    DriveBlend getDriveBlend() const { return driveBlend; }
+    
+private:
+    // Morph range over which the drive crossfades between the two curves
+    static constexpr float driveCrossfadeStart = 0.4f;
+    static constexpr float driveCrossfadeWidth = 0.2f;
+    
+    // Message thread side, copied across under the lock
+    juce::SpinLock pendingLock;
+    Snapshot pendingA, pendingB;
+    bool pendingActive = false;
+    std::atomic<bool> hasPending{false};
+    
+    // Audio thread state: the morph is A + morph * (B - A)
+    ParameterValues origin {};
+    ParameterValues difference {};
+    ParameterValues morphed {};
+    DriveBlend driveBlend;
+    float lastMorph = -1.0f;
+    bool active = false;
+    
+    double currentSampleRate = 44100.0;
+    
+    void applyPendingSnapshots();
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetMorpher)
+};
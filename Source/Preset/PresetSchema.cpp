@@ -2,6 +2,24 @@
 
 // Minimal implementations for PresetSchema classes
 
+namespace
+{
+    std::unique_ptr<EffectBlock> createEffectBlock(const juce::String& blockName)
+    {
+        if (blockName == "noise_gate") return std::make_unique<NoiseGateParams>();
+        if (blockName == "compressor") return std::make_unique<CompressorParams>();
+        if (blockName == "drive") return std::make_unique<DriveParams>();
+        if (blockName == "amp") return std::make_unique<AmpParams>();
+        if (blockName == "cab") return std::make_unique<CabinetParams>();
+        if (blockName == "chorus") return std::make_unique<ChorusParams>();
+        if (blockName == "delay") return std::make_unique<DelayParams>();
+        if (blockName == "reverb") return std::make_unique<ReverbParams>();
+        if (blockName == "eq") return std::make_unique<EqualizerParams>();
+        if (blockName == "multiband") return std::make_unique<MultibandDynamicsParams>();
+        return nullptr;
+    }
+}
+
 // PresetData implementation
 PresetData::PresetData(const PresetData& other)
     : name(other.name), notes(other.notes)
@@ -53,9 +71,26 @@ void PresetData::fromVar(const juce::var& var)
     if (var.hasProperty("notes"))
         notes = var["notes"].toString();
     
-    // Chain parsing would be implemented here
-    // For now, just clear the chain
     chain.clear();
+    
+    // Blocks keep the preset's order; unknown block names are skipped
+    auto chainArray = var["chain"];
+    if (chainArray.isArray())
+    {
+        for (int i = 0; i < chainArray.size(); ++i)
+        {
+            auto blockVar = chainArray[i];
+            if (!blockVar.isObject())
+                continue;
+            
+            auto block = createEffectBlock(blockVar["block"].toString());
+            if (block)
+            {
+                block->fromVar(blockVar);
+                chain.push_back(std::move(block));
+            }
+        }
+    }
 }
 
 juce::String PresetData::getJSONSchema()
@@ -92,7 +127,7 @@ void PresetData::clampToValidRanges()
     // Implementation would clamp all parameter values to valid ranges
 }
 
-// Stub implementations for parameter classes
+// Parameter classes: each block is {"block", "enabled", "params"}
 juce::var NoiseGateParams::toVar() const
 {
     auto obj = new juce::DynamicObject();
@@ -102,6 +137,15 @@ juce::var NoiseGateParams::toVar() const
     auto params = new juce::DynamicObject();
     params->setProperty("threshold_db", thresholdDb);
     params->setProperty("release_ms", releaseMs);
+    params->setProperty("mode", juce::StringArray { "gate", "duck", "rhythmic" }[juce::jlimit(0, 2, mode)]);
+    
+    juce::String stepString;
+    for (int step = 0; step < steps; ++step)
+        stepString << (((pattern >> step) & 1u) != 0 ? "x" : ".");
+    
+    params->setProperty("pattern", stepString);
+    params->setProperty("smoothing", smoothing);
+    params->setProperty("depth", depth);
     obj->setProperty("params", juce::var(params));
     
     return juce::var(obj);
@@ -115,33 +159,358 @@ void NoiseGateParams::fromVar(const juce::var& var)
     {
         thresholdDb = params.getProperty("threshold_db", -55.0f);
         releaseMs = params.getProperty("release_ms", 100.0f);
+        smoothing = params.getProperty("smoothing", smoothing);
+        depth = params.getProperty("depth", depth);
+        
+        if (params.hasProperty("mode"))
+            mode = juce::jmax(0, juce::StringArray { "gate", "duck", "rhythmic" }.indexOf(params["mode"].toString()));
+        
+        // Anything but 32 characters is read as 16 steps
+        auto stepString = params["pattern"].toString();
+        if (stepString.isNotEmpty())
+        {
+            steps = (stepString.length() == 32) ? 32 : 16;
+            pattern = 0;
+            
+            for (int step = 0; step < juce::jmin(steps, stepString.length()); ++step)
+                if (stepString[step] == 'x' || stepString[step] == 'X')
+                    pattern |= 1u << step;
+        }
     }
 }
 
-// Similar stub implementations for other parameter classes
-juce::var CompressorParams::toVar() const { return juce::var(); }
-void CompressorParams::fromVar(const juce::var& var) {}
+juce::var CompressorParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "compressor");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("ratio", ratio);
+    params->setProperty("threshold_db", thresholdDb);
+    params->setProperty("attack_ms", attackMs);
+    params->setProperty("release_ms", releaseMs);
+    params->setProperty("makeup_db", makeupDb);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
+
+void CompressorParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        ratio = params.getProperty("ratio", ratio);
+        thresholdDb = params.getProperty("threshold_db", thresholdDb);
+        attackMs = params.getProperty("attack_ms", attackMs);
+        releaseMs = params.getProperty("release_ms", releaseMs);
+        makeupDb = params.getProperty("makeup_db", makeupDb);
+    }
+}
 
-juce::var DriveParams::toVar() const { return juce::var(); }
-void DriveParams::fromVar(const juce::var& var) {}
+juce::var DriveParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "drive");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("type", driveTypeToString(driveType));
+    params->setProperty("drive", drive);
+    params->setProperty("tone", tone);
+    params->setProperty("oversample", oversample);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
 
-juce::var AmpParams::toVar() const { return juce::var(); }
-void AmpParams::fromVar(const juce::var& var) {}
+void DriveParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        drive = params.getProperty("drive", drive);
+        tone = params.getProperty("tone", tone);
+        
+        if (params.hasProperty("type"))
+            driveType = stringToDriveType(params["type"].toString());
+        
+        // Only 1x, 2x and 4x exist; anything else rounds down to one of them
+        const int factor = params.getProperty("oversample", oversample);
+        oversample = factor >= 4 ? 4 : (factor >= 2 ? 2 : 1);
+    }
+}
 
-juce::var CabinetParams::toVar() const { return juce::var(); }
-void CabinetParams::fromVar(const juce::var& var) {}
+juce::var AmpParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "amp");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("model", ampModelToString(model));
+    params->setProperty("gain", gain);
+    params->setProperty("bass", bass);
+    params->setProperty("mid", mid);
+    params->setProperty("treble", treble);
+    params->setProperty("presence", presence);
+    params->setProperty("master", master);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
 
-juce::var ChorusParams::toVar() const { return juce::var(); }
-void ChorusParams::fromVar(const juce::var& var) {}
+void AmpParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        gain = params.getProperty("gain", gain);
+        bass = params.getProperty("bass", bass);
+        mid = params.getProperty("mid", mid);
+        treble = params.getProperty("treble", treble);
+        presence = params.getProperty("presence", presence);
+        master = params.getProperty("master", master);
+        
+        if (params.hasProperty("model"))
+            model = stringToAmpModel(params["model"].toString());
+    }
+}
 
-juce::var DelayParams::toVar() const { return juce::var(); }
-void DelayParams::fromVar(const juce::var& var) {}
+juce::var CabinetParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "cab");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("ir_name", cabinetIRToString(irName));
+    params->setProperty("lo_cut_hz", loCutHz);
+    params->setProperty("hi_cut_hz", hiCutHz);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
 
-juce::var ReverbParams::toVar() const { return juce::var(); }
-void ReverbParams::fromVar(const juce::var& var) {}
+void CabinetParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        loCutHz = params.getProperty("lo_cut_hz", loCutHz);
+        hiCutHz = params.getProperty("hi_cut_hz", hiCutHz);
+        
+        if (params.hasProperty("ir_name"))
+            irName = stringToCabinetIR(params["ir_name"].toString());
+    }
+}
 
-juce::var EqualizerParams::toVar() const { return juce::var(); }
-void EqualizerParams::fromVar(const juce::var& var) {}
+juce::var ChorusParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "chorus");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("rate_hz", rateHz);
+    params->setProperty("depth", depth);
+    params->setProperty("mix", mix);
+    params->setProperty("voices", voices);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
+
+void ChorusParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        rateHz = params.getProperty("rate_hz", rateHz);
+        depth = params.getProperty("depth", depth);
+        mix = params.getProperty("mix", mix);
+        voices = juce::jlimit(1, 8, static_cast<int>(params.getProperty("voices", voices)));
+    }
+}
+
+juce::var DelayParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "delay");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("time_ms", timeMs);
+    params->setProperty("feedback", feedback);
+    params->setProperty("mix", mix);
+    params->setProperty("tempo_sync", tempoSync);
+    params->setProperty("division", noteDivisionToString(division));
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
+
+void DelayParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        timeMs = params.getProperty("time_ms", timeMs);
+        feedback = params.getProperty("feedback", feedback);
+        mix = params.getProperty("mix", mix);
+        tempoSync = params.getProperty("tempo_sync", tempoSync);
+        
+        if (params.hasProperty("division"))
+            division = stringToNoteDivision(params["division"].toString());
+    }
+}
+
+juce::var ReverbParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "reverb");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("algo", reverbAlgorithmToString(algorithm));
+    params->setProperty("pre_delay_ms", preDelayMs);
+    params->setProperty("decay_s", decayS);
+    params->setProperty("damping", damping);
+    params->setProperty("mix", mix);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
+
+void ReverbParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        preDelayMs = params.getProperty("pre_delay_ms", preDelayMs);
+        decayS = params.getProperty("decay_s", decayS);
+        damping = params.getProperty("damping", damping);
+        mix = params.getProperty("mix", mix);
+        
+        if (params.hasProperty("algo"))
+            algorithm = stringToReverbAlgorithm(params["algo"].toString());
+    }
+}
+
+juce::var EqualizerParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "eq");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("low_shelf_hz", lowShelfHz);
+    params->setProperty("low_gain_db", lowGainDb);
+    params->setProperty("mid_hz", midHz);
+    params->setProperty("mid_q", midQ);
+    params->setProperty("mid_gain_db", midGainDb);
+    params->setProperty("high_shelf_hz", highShelfHz);
+    params->setProperty("high_gain_db", highGainDb);
+    params->setProperty("analog", analogModeling);
+    params->setProperty("mid_dynamic", midDynamic);
+    params->setProperty("mid_dynamic_threshold_db", midDynamicThresholdDb);
+    params->setProperty("mid_dynamic_range_db", midDynamicRangeDb);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
+
+void EqualizerParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (params.isObject())
+    {
+        lowShelfHz = params.getProperty("low_shelf_hz", lowShelfHz);
+        lowGainDb = params.getProperty("low_gain_db", lowGainDb);
+        midHz = params.getProperty("mid_hz", midHz);
+        midQ = params.getProperty("mid_q", midQ);
+        midGainDb = params.getProperty("mid_gain_db", midGainDb);
+        highShelfHz = params.getProperty("high_shelf_hz", highShelfHz);
+        highGainDb = params.getProperty("high_gain_db", highGainDb);
+        analogModeling = params.getProperty("analog", analogModeling);
+        midDynamic = params.getProperty("mid_dynamic", midDynamic);
+        midDynamicThresholdDb = params.getProperty("mid_dynamic_threshold_db", midDynamicThresholdDb);
+        midDynamicRangeDb = params.getProperty("mid_dynamic_range_db", midDynamicRangeDb);
+    }
+}
+
+juce::var MultibandDynamicsParams::toVar() const
+{
+    auto obj = new juce::DynamicObject();
+    obj->setProperty("block", "multiband");
+    obj->setProperty("enabled", enabled);
+    
+    auto params = new juce::DynamicObject();
+    params->setProperty("bands", numBands);
+    
+    juce::Array<juce::var> crossovers;
+    for (int i = 0; i < numBands - 1; ++i)
+        crossovers.add(crossoverHz[static_cast<size_t>(i)]);
+    params->setProperty("crossover_hz", crossovers);
+    
+    juce::Array<juce::var> bandArray;
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto& band = bands[static_cast<size_t>(i)];
+        auto bandObj = new juce::DynamicObject();
+        bandObj->setProperty("threshold_db", band.thresholdDb);
+        bandObj->setProperty("ratio", band.ratio);
+        bandObj->setProperty("attack_ms", band.attackMs);
+        bandObj->setProperty("release_ms", band.releaseMs);
+        bandObj->setProperty("makeup_db", band.makeupDb);
+        bandObj->setProperty("gate_threshold_db", band.gateThresholdDb);
+        bandArray.add(juce::var(bandObj));
+    }
+    params->setProperty("band_params", bandArray);
+    obj->setProperty("params", juce::var(params));
+    
+    return juce::var(obj);
+}
+
+void MultibandDynamicsParams::fromVar(const juce::var& var)
+{
+    enabled = var.getProperty("enabled", true);
+    auto params = var["params"];
+    if (!params.isObject())
+        return;
+    
+    numBands = juce::jlimit(2, 4, static_cast<int>(params.getProperty("bands", numBands)));
+    
+    if (auto* crossovers = params["crossover_hz"].getArray())
+    {
+        for (int i = 0; i < juce::jmin(crossovers->size(), 3); ++i)
+            crossoverHz[static_cast<size_t>(i)] = static_cast<float>((*crossovers)[i]);
+    }
+    
+    if (auto* bandArray = params["band_params"].getArray())
+    {
+        for (int i = 0; i < juce::jmin(bandArray->size(), 4); ++i)
+        {
+            const auto& bandVar = (*bandArray)[i];
+            auto& band = bands[static_cast<size_t>(i)];
+            band.thresholdDb = bandVar.getProperty("threshold_db", band.thresholdDb);
+            band.ratio = bandVar.getProperty("ratio", band.ratio);
+            band.attackMs = bandVar.getProperty("attack_ms", band.attackMs);
+            band.releaseMs = bandVar.getProperty("release_ms", band.releaseMs);
+            band.makeupDb = bandVar.getProperty("makeup_db", band.makeupDb);
+            band.gateThresholdDb = bandVar.getProperty("gate_threshold_db", band.gateThresholdDb);
+        }
+    }
+}
 
 // Utility functions
 juce::String effectBlockTypeToString(EffectBlockType type)
@@ -157,6 +526,7 @@ juce::String effectBlockTypeToString(EffectBlockType type)
         case EffectBlockType::Delay: return "delay";
         case EffectBlockType::Reverb: return "reverb";
         case EffectBlockType::Equalizer: return "eq";
+        case EffectBlockType::MultibandDynamics: return "multiband";
         default: return "unknown";
     }
 }
@@ -172,6 +542,7 @@ EffectBlockType stringToEffectBlockType(const juce::String& str)
     if (str == "delay") return EffectBlockType::Delay;
     if (str == "reverb") return EffectBlockType::Reverb;
     if (str == "eq") return EffectBlockType::Equalizer;
+    if (str == "multiband") return EffectBlockType::MultibandDynamics;
     return EffectBlockType::NoiseGate; // default
 }
 
@@ -244,6 +615,7 @@ juce::String reverbAlgorithmToString(ReverbAlgorithm algo)
         case ReverbAlgorithm::Plate: return "plate";
         case ReverbAlgorithm::Hall: return "hall";
         case ReverbAlgorithm::Shimmer: return "shimmer";
+        case ReverbAlgorithm::Convolution: return "convolution";
         default: return "plate";
     }
 }
@@ -254,5 +626,67 @@ ReverbAlgorithm stringToReverbAlgorithm(const juce::String& str)
     if (str == "plate") return ReverbAlgorithm::Plate;
     if (str == "hall") return ReverbAlgorithm::Hall;
     if (str == "shimmer") return ReverbAlgorithm::Shimmer;
+    if (str == "convolution") return ReverbAlgorithm::Convolution;
     return ReverbAlgorithm::Plate; // default
 }
+
+juce::String noteDivisionToString(NoteDivision division)
+{
+    switch (division)
+    {
+        case NoteDivision::Whole: return "1/1";
+        case NoteDivision::Half: return "1/2";
+        case NoteDivision::Quarter: return "1/4";
+        case NoteDivision::Eighth: return "1/8";
+        case NoteDivision::Sixteenth: return "1/16";
+        case NoteDivision::DottedHalf: return "1/2d";
+        case NoteDivision::DottedQuarter: return "1/4d";
+        case NoteDivision::DottedEighth: return "1/8d";
+        case NoteDivision::DottedSixteenth: return "1/16d";
+        case NoteDivision::HalfTriplet: return "1/2t";
+        case NoteDivision::QuarterTriplet: return "1/4t";
+        case NoteDivision::EighthTriplet: return "1/8t";
+        case NoteDivision::SixteenthTriplet: return "1/16t";
+        default: return "1/4";
+    }
+}
+
+NoteDivision stringToNoteDivision(const juce::String& str)
+{
+    if (str == "1/1") return NoteDivision::Whole;
+    if (str == "1/2") return NoteDivision::Half;
+    if (str == "1/4") return NoteDivision::Quarter;
+    if (str == "1/8") return NoteDivision::Eighth;
+    if (str == "1/16") return NoteDivision::Sixteenth;
+    if (str == "1/2d") return NoteDivision::DottedHalf;
+    if (str == "1/4d") return NoteDivision::DottedQuarter;
+    if (str == "1/8d") return NoteDivision::DottedEighth;
+    if (str == "1/16d") return NoteDivision::DottedSixteenth;
+    if (str == "1/2t") return NoteDivision::HalfTriplet;
+    if (str == "1/4t") return NoteDivision::QuarterTriplet;
+    if (str == "1/8t") return NoteDivision::EighthTriplet;
+    if (str == "1/16t") return NoteDivision::SixteenthTriplet;
+    return NoteDivision::Quarter; // default
+}
+
+double noteDivisionToBeats(NoteDivision division)
+{
+    // Dotted notes are 3/2 of the plain value, triplets 2/3
+    switch (division)
+    {
+        case NoteDivision::Whole: return 4.0;
+        case NoteDivision::Half: return 2.0;
+        case NoteDivision::Quarter: return 1.0;
+        case NoteDivision::Eighth: return 0.5;
+        case NoteDivision::Sixteenth: return 0.25;
+        case NoteDivision::DottedHalf: return 3.0;
+        case NoteDivision::DottedQuarter: return 1.5;
+        case NoteDivision::DottedEighth: return 0.75;
+        case NoteDivision::DottedSixteenth: return 0.375;
+        case NoteDivision::HalfTriplet: return 4.0 / 3.0;
+        case NoteDivision::QuarterTriplet: return 2.0 / 3.0;
+        case NoteDivision::EighthTriplet: return 1.0 / 3.0;
+        case NoteDivision::SixteenthTriplet: return 1.0 / 6.0;
+        default: return 1.0;
+    }
+}
@@ -2,6 +2,7 @@
 
 #include <juce_core/juce_core.h>
 #include <juce_data_structures/juce_data_structures.h>
+#include <array>
 
 // Forward declarations
 struct NoiseGateParams;
@@ -13,6 +14,7 @@ struct ChorusParams;
 struct DelayParams;
 struct ReverbParams;
 struct EqualizerParams;
+struct MultibandDynamicsParams;
 
 // Effect block types
 enum class EffectBlockType
@@ -25,7 +27,8 @@ enum class EffectBlockType
     Chorus,
     Delay,
     Reverb,
-    Equalizer
+    Equalizer,
+    MultibandDynamics
 };
 
 // Base effect block
@@ -45,6 +48,14 @@ struct NoiseGateParams : public EffectBlock
 {
     float thresholdDb = -55.0f;  // -90 to 0 dB
     float releaseMs = 100.0f;    // 5 to 500 ms
+    int mode = 0;                // 0=gate, 1=duck, 2=rhythmic
+    
+    // Rhythmic pattern over one bar, one bit per step (bit 0 first); in
+    // presets a string such as "x.x.x.x.x.x.x.x." whose length is the step count
+    juce::uint32 pattern = 0x5555;
+    int steps = 16;              // 16 or 32
+    float smoothing = 0.1f;      // 0 to 0.5 of a step
+    float depth = 0.8f;          // 0 to 1
     
     NoiseGateParams() { type = EffectBlockType::NoiseGate; }
     
@@ -148,6 +159,7 @@ struct ChorusParams : public EffectBlock
     float rateHz = 0.3f;         // 0.05 to 5 Hz
     float depth = 0.35f;         // 0 to 1
     float mix = 0.25f;           // 0 to 1
+    int voices = 1;              // 1 (classic) or 3 to 8 (ensemble)
     
     ChorusParams() { type = EffectBlockType::Chorus; }
     
@@ -161,11 +173,20 @@ struct ChorusParams : public EffectBlock
 };
 
 // Delay Parameters
+enum class NoteDivision
+{
+    Whole, Half, Quarter, Eighth, Sixteenth,
+    DottedHalf, DottedQuarter, DottedEighth, DottedSixteenth,
+    HalfTriplet, QuarterTriplet, EighthTriplet, SixteenthTriplet
+};
+
 struct DelayParams : public EffectBlock
 {
     float timeMs = 420.0f;       // 40 to 1200 ms
     float feedback = 0.35f;      // 0 to 0.95
     float mix = 0.2f;            // 0 to 1
+    bool tempoSync = false;      // follow the host tempo instead of timeMs
+    NoteDivision division = NoteDivision::Quarter;
     
     DelayParams() { type = EffectBlockType::Delay; }
     
@@ -179,7 +200,7 @@ struct DelayParams : public EffectBlock
 };
 
 // Reverb Parameters
-enum class ReverbAlgorithm { Room, Plate, Hall, Shimmer };
+enum class ReverbAlgorithm { Room, Plate, Hall, Shimmer, Convolution };
 
 struct ReverbParams : public EffectBlock
 {
@@ -205,11 +226,17 @@ struct EqualizerParams : public EffectBlock
 {
     float lowShelfHz = 120.0f;   // 60 to 200 Hz
     float lowGainDb = 1.5f;      // -12 to 12 dB
-    float midHz = 1200.0f;       // 300 to 3000 Hz
+    float midHz = 1200.0f;       // 300 to 5000 Hz
     float midQ = 0.9f;           // 0.3 to 4
     float midGainDb = -1.0f;     // -12 to 12 dB
     float highShelfHz = 6000.0f; // 4000 to 10000 Hz
     float highGainDb = 1.0f;     // -12 to 12 dB
+    bool analogModeling = true;
+    
+    // Extra mid cut once the mid band passes the threshold
+    bool midDynamic = false;
+    float midDynamicThresholdDb = -24.0f; // -60 to 0 dB
+    float midDynamicRangeDb = 6.0f;       // 0 to 18 dB
     
     EqualizerParams() { type = EffectBlockType::Equalizer; }
     
@@ -222,6 +249,41 @@ struct EqualizerParams : public EffectBlock
     void fromVar(const juce::var& var) override;
 };
 
+// Multiband Dynamics Parameters
+struct MultibandDynamicsParams : public EffectBlock
+{
+    struct Band
+    {
+        float thresholdDb = -24.0f;      // -60 to 0 dB
+        float ratio = 2.0f;              // 1 to 10
+        float attackMs = 10.0f;          // 0.1 to 50 ms
+        float releaseMs = 120.0f;        // 10 to 500 ms
+        float makeupDb = 0.0f;           // -12 to 12 dB
+        float gateThresholdDb = -90.0f;  // -90 (off) to -20 dB
+    };
+    
+    int numBands = 3;                                           // 2 to 4
+    std::array<float, 3> crossoverHz { 150.0f, 2500.0f, 6000.0f }; // 40 to 16000 Hz, first numBands - 1 used
+    std::array<Band, 4> bands;
+    
+    // Defaults tighten the low end and leave the highs nearly untouched
+    MultibandDynamicsParams()
+    {
+        type = EffectBlockType::MultibandDynamics;
+        bands[0] = { -28.0f, 4.0f, 5.0f, 80.0f, 1.0f, -90.0f };
+        bands[1] = { -22.0f, 2.0f, 10.0f, 120.0f, 0.0f, -90.0f };
+        bands[2] = { -18.0f, 1.5f, 3.0f, 100.0f, 0.0f, -90.0f };
+    }
+    
+    std::unique_ptr<EffectBlock> clone() const override
+    {
+        return std::make_unique<MultibandDynamicsParams>(*this);
+    }
+    
+    juce::var toVar() const override;
+    void fromVar(const juce::var& var) override;
+};
+
 // Complete preset data
 struct PresetData
 {
@@ -266,3 +328,7 @@ CabinetIR stringToCabinetIR(const juce::String& str);
 
 juce::String reverbAlgorithmToString(ReverbAlgorithm algo);
 ReverbAlgorithm stringToReverbAlgorithm(const juce::String& str);
+
+juce::String noteDivisionToString(NoteDivision division);
+NoteDivision stringToNoteDivision(const juce::String& str);
+double noteDivisionToBeats(NoteDivision division);   // length in quarter notes
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Polynomial log2/exp2 approximations for per-sample dB conversions
+ * Plain arithmetic and bit reinterpretation only, so loops over a block of
+ * samples vectorize where std::log10/std::pow would call into libm each time.
+ * Both are good to about 1e-4, i.e. within 0.001 dB
+ */
+namespace FastMath
+{
+    inline float log2(float x) noexcept
+    {
+        // x = 2^e * m with m in [1, 2); x must be positive and normal
+        std::uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+
+        const float exponent = static_cast<float>(static_cast<int>((bits >> 23) & 255u) - 127);
+        bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+
+        // Quartic fit of ln(m) on [1, 2), rescaled to log2
+        const float lnM = -1.7417939f + (2.8212026f + (-1.4699568f + (0.44717955f - 0.056570851f * m) * m) * m) * m;
+        return exponent + 1.4426950f * lnM;
+    }
+
+    inline float exp2(float x) noexcept
+    {
+        // x must lie in (-126, 126). With the exponent bias added it is
+        // positive, so truncation is floor
+        const float biased = x + 127.0f;
+        const int whole = static_cast<int>(biased);
+        const float f = biased - static_cast<float>(whole);
+
+        const float p = 1.0f + f * (0.6931472f + f * (0.2402265f + f * (0.05550411f + f * (0.009618129f + f * 0.0013333558f))));
+
+        const std::uint32_t bits = static_cast<std::uint32_t>(whole) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+
+        return p * scale;
+    }
+
+    // 20 log10(gain), with gains below 1e-6 (-120 dB) reading as -120 dB
+    inline float gainToDecibels(float gain) noexcept
+    {
+        constexpr float decibelsPerOctave = 6.0205999f;
+        return decibelsPerOctave * log2(std::max(gain, 1.0e-6f));
+    }
+
+    // 10^(dB / 20), for -750 dB < decibels < 750 dB
+    inline float decibelsToGain(float decibels) noexcept
+    {
+        constexpr float octavesPerDecibel = 0.16609640f;
+        return exp2(decibels * octavesPerDecibel);
+    }
+
+    // Block versions; dest may be the same array as source
+    inline void gainToDecibels(float* dest, const float* source, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = gainToDecibels(source[i]);
+    }
+
+    inline void decibelsToGain(float* dest, const float* source, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = decibelsToGain(source[i]);
+    }
+}
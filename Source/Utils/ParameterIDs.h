@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+
+/**
+ * Compile-time identifiers for the chain's continuous parameters
+ * Parameters are addressed by index on the audio thread; the string IDs
+ * are only for hosts, presets and the UI. The table below is the single
+ * description of each parameter: the plugin registers its host parameters
+ * from it and the smoother takes its defaults and curves from it
+ */
+enum class ParamID : int
+{
+    Gain,
+    Tone,
+    Drive,
+    ReverbMix,
+    ReverbDecay,
+    DelayMix,
+    DelayTime,
+    ChorusMix,
+    ChorusRate,
+    EQLow,
+    EQMid,
+    EQHigh,
+    GateThreshold,
+    EQLowShelfFreq,
+    EQLowShelfGain,
+    EQMidFreq,
+    EQMidQ,
+    EQMidGain,
+    EQHighShelfFreq,
+    EQHighShelfGain,
+    ReverbPreDelay,
+    ReverbDamping,
+    CompressorRatio,
+    CompressorThreshold,
+    CompressorAttack,
+    CompressorRelease,
+    CompressorMakeup,
+    EQDynamicThreshold,
+    EQDynamicRange,
+    NumParams
+};
+
+constexpr int numParamIDs = static_cast<int>(ParamID::NumParams);
+
+// One value per parameter, indexed by ParamID
+using ParameterValues = std::array<float, numParamIDs>;
+
+// How a parameter travels to a new target
+enum class SmoothingCurve
+{
+    Linear,             // equal steps; for values already in dB or perceptually even
+    Multiplicative,     // equal ratios about curveOrigin; for frequencies, times and gains
+    OnePole,            // exponential approach, fast start and soft landing
+    SCurve              // raised cosine, easing out of the start and into the target
+};
+
+struct ParamInfo
+{
+    const char* id;
+    const char* name;
+    float minValue;
+    float maxValue;
+    float defaultValue;
+    SmoothingCurve curve;
+    
+    // Multiplicative ramps are geometric in (value - curveOrigin). Controls
+    // mapped as f = k * (value - curveOrigin) then ramp geometrically in f
+    float curveOrigin;
+};
+
+// In ParamID order, with host ranges in the units DSPChain reads: delay time
+// in seconds, chorus rate in Hz, gate threshold in dB. Tone and the EQ
+// shelves map linearly onto cutoffs in DSPChain: tone 500 + 7500 t,
+// low 20 + 2000 v, high 2000 + 18000 v, and reverb decay onto 0.2 + 11.8 v
+// seconds. The eq_ bands after the gate are the preset eq block's Equalizer
+// next to the drive, in Hz and dB; the reverb pre-delay is in ms, and the
+// compressor's threshold and makeup in dB with attack and release in ms.
+// The eq_dyn_ pair sets, in dB, where the eq's dynamic mid starts cutting
+// and how far it can cut
+constexpr std::array<ParamInfo, numParamIDs> paramInfo {{
+    { "gain",             "Gain",             0.0f,    2.0f,     1.0f,    SmoothingCurve::Multiplicative, 0.0f },
+    { "tone",             "Tone",             0.0f,    1.0f,     0.5f,    SmoothingCurve::Multiplicative, -1.0f / 15.0f },
+    { "drive",            "Drive",            0.0f,    1.0f,     0.0f,    SmoothingCurve::Linear,         0.0f },
+    { "reverb_mix",       "Reverb Mix",       0.0f,    1.0f,     0.0f,    SmoothingCurve::SCurve,         0.0f },
+    { "reverb_decay",     "Reverb Decay",     0.0f,    1.0f,     0.5f,    SmoothingCurve::OnePole,        0.0f },
+    { "delay_mix",        "Delay Mix",        0.0f,    1.0f,     0.0f,    SmoothingCurve::SCurve,         0.0f },
+    { "delay_time",       "Delay Time",       0.0f,    2.0f,     0.25f,   SmoothingCurve::Multiplicative, 0.0f },
+    { "chorus_mix",       "Chorus Mix",       0.0f,    1.0f,     0.0f,    SmoothingCurve::SCurve,         0.0f },
+    { "chorus_rate",      "Chorus Rate",      0.1f,    5.0f,     0.5f,    SmoothingCurve::Multiplicative, 0.0f },
+    { "eq_low",           "EQ Low",           0.0f,    1.0f,     0.5f,    SmoothingCurve::Multiplicative, -0.01f },
+    { "eq_mid",           "EQ Mid",           0.0f,    1.0f,     0.5f,    SmoothingCurve::Linear,         0.0f },
+    { "eq_high",          "EQ High",          0.0f,    1.0f,     0.5f,    SmoothingCurve::Multiplicative, -1.0f / 9.0f },
+    { "gate_threshold",   "Gate Threshold",   -90.0f,  0.0f,     -55.0f,  SmoothingCurve::Linear,         0.0f },
+    { "eq_low_shelf_hz",  "EQ Low Shelf",     60.0f,   200.0f,   120.0f,  SmoothingCurve::Multiplicative, 0.0f },
+    { "eq_low_gain_db",   "EQ Low Gain",      -12.0f,  12.0f,    1.5f,    SmoothingCurve::Linear,         0.0f },
+    { "eq_mid_hz",        "EQ Mid Frequency", 300.0f,  5000.0f,  1200.0f, SmoothingCurve::Multiplicative, 0.0f },
+    { "eq_mid_q",         "EQ Mid Q",         0.3f,    4.0f,     0.9f,    SmoothingCurve::Multiplicative, 0.0f },
+    { "eq_mid_gain_db",   "EQ Mid Gain",      -12.0f,  12.0f,    -1.0f,   SmoothingCurve::Linear,         0.0f },
+    { "eq_high_shelf_hz", "EQ High Shelf",    4000.0f, 10000.0f, 6000.0f, SmoothingCurve::Multiplicative, 0.0f },
+    { "eq_high_gain_db",  "EQ High Gain",     -12.0f,  12.0f,    1.0f,    SmoothingCurve::Linear,         0.0f },
+    { "reverb_predelay",  "Reverb Pre-Delay", 0.0f,    60.0f,    12.0f,   SmoothingCurve::Linear,         0.0f },
+    { "reverb_damping",   "Reverb Damping",   0.0f,    1.0f,     0.35f,   SmoothingCurve::Linear,         0.0f },
+    { "comp_ratio",       "Comp Ratio",       1.0f,    10.0f,    3.0f,    SmoothingCurve::Multiplicative, 0.0f },
+    { "comp_threshold",   "Comp Threshold",   -60.0f,  0.0f,     -18.0f,  SmoothingCurve::Linear,         0.0f },
+    { "comp_attack",      "Comp Attack",      0.1f,    50.0f,    10.0f,   SmoothingCurve::Multiplicative, 0.0f },
+    { "comp_release",     "Comp Release",     10.0f,   500.0f,   60.0f,   SmoothingCurve::Multiplicative, 0.0f },
+    { "comp_makeup",      "Comp Makeup",      -12.0f,  12.0f,    2.0f,    SmoothingCurve::Linear,         0.0f },
+    { "eq_dyn_threshold", "EQ Dyn Threshold", -60.0f,  0.0f,     -24.0f,  SmoothingCurve::Linear,         0.0f },
+    { "eq_dyn_range",     "EQ Dyn Range",     0.0f,    18.0f,    6.0f,    SmoothingCurve::Linear,         0.0f }
+}};
+
+constexpr int toIndex(ParamID id) { return static_cast<int>(id); }
+constexpr const ParamInfo& getParamInfo(ParamID id) { return paramInfo[static_cast<size_t>(id)]; }
@@ -2,6 +2,13 @@
 
 ParameterSmoother::ParameterSmoother()
 {
+    for (int i = 0; i < numParamIDs; ++i)
+    {
+        const auto& info = paramInfo[static_cast<size_t>(i)];
+        current[static_cast<size_t>(i)] = info.defaultValue;
+        target[static_cast<size_t>(i)] = info.defaultValue;
+        curves[static_cast<size_t>(i)].store(static_cast<int>(info.curve), std::memory_order_relaxed);
+    }
 }
 
 ParameterSmoother::~ParameterSmoother()
@@ -11,125 +18,286 @@ ParameterSmoother::~ParameterSmoother()
 void ParameterSmoother::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    rampStorage.assign(static_cast<size_t>(numParamIDs * maxBlockSize), 0.0f);
     
-    // Update all smoothers with new sample rate
-    for (auto& [paramId, param] : parameters)
-    {
-        param.smoother.reset(sampleRate, 0.05); // 50ms default ramp
-    }
+    // Ramps in flight were timed at the old rate; land them
+    reset();
 }
 
 void ParameterSmoother::reset()
 {
-    for (auto& [paramId, param] : parameters)
-    {
-        param.smoother.reset(currentSampleRate, 0.05);
-        param.isActive = false;
-    }
+    current = target;
+    remaining.fill(0);
+    
+    for (size_t lane = 0; lane < remaining.size(); ++lane)
+        holdLane(lane);
+    
+    activeMask = 0;
+    rampedMask = 0;
     isPresetTransition = false;
 }
 
-void ParameterSmoother::addParameter(const juce::String& paramId, float initialValue)
+void ParameterSmoother::setTargetValue(ParamID paramId, float targetValue, float rampTimeSeconds)
+{
+    const auto index = static_cast<size_t>(paramId);
+    pendingTarget[index].store(targetValue, std::memory_order_relaxed);
+    pendingRampSeconds[index].store(rampTimeSeconds, std::memory_order_relaxed);
+    
+    // Publishes the two stores above to the audio thread
+    pendingMask.fetch_or(bit(paramId), std::memory_order_release);
+}
+
+void ParameterSmoother::setCurrentValue(ParamID paramId, float currentValue)
+{
+    const auto index = static_cast<size_t>(paramId);
+    current[index] = currentValue;
+    target[index] = currentValue;
+    remaining[index] = 0;
+    holdLane(index);
+    activeMask &= ~bit(paramId);
+    rampedMask &= ~bit(paramId);
+}
+
+void ParameterSmoother::setSmoothingCurve(ParamID paramId, SmoothingCurve curve)
 {
-    parameters[paramId] = SmoothedParameter();
-    parameters[paramId].smoother.setCurrentAndTargetValue(initialValue);
-    parameters[paramId].targetValue = initialValue;
+    curves[static_cast<size_t>(paramId)].store(static_cast<int>(curve), std::memory_order_relaxed);
 }
 
-void ParameterSmoother::setTargetValue(const juce::String& paramId, float targetValue, float rampTimeSeconds)
+void ParameterSmoother::applyPendingTargets()
 {
-    auto it = parameters.find(paramId);
-    if (it != parameters.end())
+    auto mask = pendingMask.exchange(0, std::memory_order_acquire);
+    
+    while (mask != 0)
     {
-        it->second.smoother.reset(currentSampleRate, rampTimeSeconds);
-        it->second.smoother.setTargetValue(targetValue);
-        it->second.targetValue = targetValue;
-        it->second.isActive = true;
+        const int index = juce::findHighestSetBit(mask);
+        mask &= ~(1u << static_cast<juce::uint32>(index));
+    
+        const auto lane = static_cast<size_t>(index);
+        const float newTarget = pendingTarget[lane].load(std::memory_order_relaxed);
+        const double rampSeconds = pendingRampSeconds[lane].load(std::memory_order_relaxed);
+    
+        // Re-posting the current target leaves its ramp running
+        if (newTarget != target[lane])
+            startRamp(lane, newTarget, juce::roundToInt(rampSeconds * currentSampleRate));
     }
 }
 
-void ParameterSmoother::setCurrentValue(const juce::String& paramId, float currentValue)
+void ParameterSmoother::startRamp(size_t lane, float newTarget, int rampSamples)
 {
-    auto it = parameters.find(paramId);
-    if (it != parameters.end())
+    target[lane] = newTarget;
+    
+    if (rampSamples < 1)
     {
-        it->second.smoother.setCurrentAndTargetValue(currentValue);
-        it->second.targetValue = currentValue;
-        it->second.isActive = false;
+        current[lane] = newTarget;
+        remaining[lane] = 0;
+        holdLane(lane);
+        activeMask &= ~(1u << static_cast<juce::uint32>(lane));
+        return;
     }
+    
+    const double start = current[lane];
+    const double end = newTarget;
+    const double length = rampSamples;
+    auto curve = static_cast<SmoothingCurve>(curves[lane].load(std::memory_order_relaxed));
+    
+    // A geometric ramp needs both ends on the same side of its origin
+    const double curveOrigin = paramInfo[lane].curveOrigin;
+    if (curve == SmoothingCurve::Multiplicative && (start - curveOrigin) * (end - curveOrigin) <= 0.0)
+        curve = SmoothingCurve::Linear;
+    
+    // Each curve as y' = a y + b y_prev + c about its origin, with y and
+    // y_prev the values at samples 0 and -1
+    switch (curve)
+    {
+        case SmoothingCurve::Multiplicative:
+        {
+            const double ratio = std::pow((end - curveOrigin) / (start - curveOrigin), 1.0 / length);
+            origin[lane] = curveOrigin;
+            state[lane] = start - curveOrigin;
+            previousState[lane] = 0.0;
+            stateMultiplier[lane] = ratio;
+            previousMultiplier[lane] = 0.0;
+            stateOffset[lane] = 0.0;
+            break;
+        }
+        case SmoothingCurve::OnePole:
+        {
+            const double decay = std::exp(-onePoleTimeConstants / length);
+            origin[lane] = 0.0;
+            state[lane] = start;
+            previousState[lane] = 0.0;
+            stateMultiplier[lane] = decay;
+            previousMultiplier[lane] = 0.0;
+            stateOffset[lane] = (1.0 - decay) * end;
+            break;
+        }
+        case SmoothingCurve::SCurve:
+        {
+            // mid - amplitude cos(pi n / length), from the start at n = 0 to the
+            // end at n = length; the cosine follows the Chebyshev recurrence
+            const double omega = juce::MathConstants<double>::pi / length;
+            const double amplitude = 0.5 * (end - start);
+            origin[lane] = 0.5 * (start + end);
+            state[lane] = -amplitude;
+            previousState[lane] = -amplitude * std::cos(omega);
+            stateMultiplier[lane] = 2.0 * std::cos(omega);
+            previousMultiplier[lane] = -1.0;
+            stateOffset[lane] = 0.0;
+            break;
+        }
+        case SmoothingCurve::Linear:
+        default:
+        {
+            // Extrapolation from the last two values: y' = 2 y - y_prev
+            origin[lane] = 0.0;
+            state[lane] = start;
+            previousState[lane] = start - (end - start) / length;
+            stateMultiplier[lane] = 2.0;
+            previousMultiplier[lane] = -1.0;
+            stateOffset[lane] = 0.0;
+            break;
+        }
+    }
+    
+    remaining[lane] = rampSamples;
+    activeMask |= 1u << static_cast<juce::uint32>(lane);
 }
 
-void ParameterSmoother::process(int numSamples)
+void ParameterSmoother::advanceRamps(int numSamples)
 {
-    for (auto& [paramId, param] : parameters)
+    const auto rowLength = static_cast<size_t>(maxBlockSize);
+    float* rows = rampStorage.data();
+    
+    // The lanes in motion, and the steps the longest of their ramps takes this block
+    int steps = 0;
+    int count = 0;
+    std::array<size_t, numParamIDs> lanes;
+    
+    for (auto mask = activeMask; mask != 0; ++count)
+    {
+        const int index = juce::findHighestSetBit(mask);
+        mask &= ~(1u << static_cast<juce::uint32>(index));
+        lanes[static_cast<size_t>(count)] = static_cast<size_t>(index);
+        steps = juce::jmax(steps, juce::jmin(remaining[static_cast<size_t>(index)], numSamples));
+    }
+    
+    if (count * 2 > numParamIDs)
     {
-        if (param.isActive)
+        // Most lanes moving: the whole table advances at once, sample by
+        // sample. The lane loop has a fixed length and no branches, so it
+        // runs as a few vector multiply-adds; lanes at rest or finishing
+        // early compute values nobody reads, and are put right below
+        for (int n = 0; n < steps; ++n)
         {
-            param.smoother.skip(numSamples);
-            
-            // Check if we've reached the target
-            if (std::abs(param.smoother.getCurrentValue() - param.targetValue) < 0.001f)
+            for (size_t lane = 0; lane < static_cast<size_t>(numParamIDs); ++lane)
             {
-                param.smoother.setCurrentAndTargetValue(param.targetValue);
-                param.isActive = false;
+                const double next = stateMultiplier[lane] * state[lane] + previousMultiplier[lane] * previousState[lane] + stateOffset[lane];
+                previousState[lane] = state[lane];
+                state[lane] = next;
+                rows[lane * rowLength + static_cast<size_t>(n)] = static_cast<float>(origin[lane] + next);
             }
         }
     }
-}
-
-float ParameterSmoother::getCurrentValue(const juce::String& paramId) const
-{
-    auto it = parameters.find(paramId);
-    if (it != parameters.end())
+    else
     {
-        return it->second.smoother.getCurrentValue();
+        // A few lanes moving: gathered into contiguous slots for the block,
+        // so the work scales with the lanes in motion
+        alignas(32) std::array<double, numParamIDs> a, b, c, y, yPrevious, base;
+        std::array<float*, numParamIDs> ramps;
+    
+        for (size_t slot = 0; slot < static_cast<size_t>(count); ++slot)
+        {
+            const auto lane = lanes[slot];
+            a[slot] = stateMultiplier[lane];
+            b[slot] = previousMultiplier[lane];
+            c[slot] = stateOffset[lane];
+            y[slot] = state[lane];
+            yPrevious[slot] = previousState[lane];
+            base[slot] = origin[lane];
+            ramps[slot] = rows + lane * rowLength;
+        }
+    
+        for (int n = 0; n < steps; ++n)
+        {
+            for (size_t slot = 0; slot < static_cast<size_t>(count); ++slot)
+            {
+                const double next = a[slot] * y[slot] + b[slot] * yPrevious[slot] + c[slot];
+                yPrevious[slot] = y[slot];
+                y[slot] = next;
+                ramps[slot][n] = static_cast<float>(base[slot] + next);
+            }
+        }
+    
+        for (size_t slot = 0; slot < static_cast<size_t>(count); ++slot)
+        {
+            state[lanes[slot]] = y[slot];
+            previousState[lanes[slot]] = yPrevious[slot];
+        }
+    }
+    
+    for (size_t slot = 0; slot < static_cast<size_t>(count); ++slot)
+    {
+        const auto lane = lanes[slot];
+        float* ramp = rows + lane * rowLength;
+        const int laneSteps = juce::jmin(remaining[lane], numSamples);
+        remaining[lane] -= laneSteps;
+    
+        if (remaining[lane] > 0)
+        {
+            current[lane] = ramp[numSamples - 1];
+            continue;
+        }
+    
+        // The last step lands on the target exactly, and the ramp holds it
+        const float end = target[lane];
+        std::fill(ramp + juce::jmax(0, laneSteps - 1), ramp + numSamples, end);
+        current[lane] = end;
+        holdLane(lane);
+        activeMask &= ~(1u << static_cast<juce::uint32>(lane));
     }
-    return 0.0f;
 }
 
-bool ParameterSmoother::isSmoothing(const juce::String& paramId) const
+void ParameterSmoother::holdLane(size_t lane)
 {
-    auto it = parameters.find(paramId);
-    if (it != parameters.end())
-    {
-        return it->second.isActive;
-    }
-    return false;
+    // y' = y: a lane at rest stays put while the whole table advances,
+    // rather than running on into overflow or denormals
+    stateMultiplier[lane] = 1.0;
+    previousMultiplier[lane] = 0.0;
+    stateOffset[lane] = 0.0;
 }
 
-bool ParameterSmoother::isAnyParameterSmoothing() const
+void ParameterSmoother::process(int numSamples)
 {
-    for (const auto& [paramId, param] : parameters)
-    {
-        if (param.isActive)
-            return true;
-    }
-    return false;
+    if (pendingMask.load(std::memory_order_relaxed) != 0)
+        applyPendingTargets();
+    
+    rampedMask = 0;
+    
+    if (activeMask == 0 || numSamples <= 0)
+        return;
+    
+    // A block longer than the rows is advanced through them a row at a time
+    // and handed over as constants
+    if (numSamples <= maxBlockSize)
+        rampedMask = activeMask;
+    
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+        advanceRamps(juce::jmin(maxBlockSize, numSamples - offset));
 }
 
 void ParameterSmoother::beginPresetTransition(float rampTimeSeconds)
 {
     isPresetTransition = true;
-    
-    // Reset all smoothers with the transition time
-    for (auto& [paramId, param] : parameters)
-    {
-        param.smoother.reset(currentSampleRate, rampTimeSeconds);
-    }
+    transitionRampSeconds = rampTimeSeconds;
 }
 
-void ParameterSmoother::setAllTargetValues(const std::map<juce::String, float>& targetValues)
+void ParameterSmoother::setAllTargetValues(const ParameterValues& targetValues)
 {
-    for (const auto& [paramId, targetValue] : targetValues)
-    {
-        auto it = parameters.find(paramId);
-        if (it != parameters.end())
-        {
-            it->second.smoother.setTargetValue(targetValue);
-            it->second.targetValue = targetValue;
-            it->second.isActive = true;
-        }
-    }
+    const float rampTimeSeconds = isPresetTransition ? transitionRampSeconds : 0.05f;
+    
+    for (int i = 0; i < numParamIDs; ++i)
+        setTargetValue(static_cast<ParamID>(i), targetValues[static_cast<size_t>(i)], rampTimeSeconds);
 }
 
 void ParameterSmoother::endPresetTransition()
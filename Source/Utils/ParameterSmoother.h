@@ -1,10 +1,23 @@
 #pragma once
 
 #include <juce_dsp/juce_dsp.h>
+#include "ParameterIDs.h"
+#include <array>
+#include <atomic>
+#include <vector>
 
 /**
  * Multi-parameter smoother for glitch-free parameter changes
- * Handles smooth transitions when AI generates new presets
+ * Handles smooth transitions when AI generates new presets.
+ * Parameters are indexed by ParamID and each follows its own curve from
+ * the ParamID table. Every curve is the same second-order recurrence,
+ * y' = a y + b y_prev + c with value = origin + y, with its multipliers
+ * worked out once when a ramp starts, so advancing a ramp costs two
+ * multiply-adds per sample whatever its shape. Targets set from other
+ * threads are posted through atomics and a pending bit mask, and picked up
+ * at the next block. Each block, every moving parameter is rendered into a
+ * ramp buffer of its own that DSP stages read sample by sample; a
+ * parameter at rest is handed over as a single constant instead
  */
 class ParameterSmoother
 {
@@ -16,38 +29,92 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock);
     void reset();
     
-    // Parameter management
-    void addParameter(const juce::String& paramId, float initialValue = 0.0f);
-    void setTargetValue(const juce::String& paramId, float targetValue, float rampTimeSeconds = 0.05f);
-    void setCurrentValue(const juce::String& paramId, float currentValue);
+    // Parameter management (any thread; applied at the start of the next block)
+    void setTargetValue(ParamID paramId, float targetValue, float rampTimeSeconds = 0.05f);
     
-    // Processing
+    // Jumps straight to the value (audio thread, or before playback starts)
+    void setCurrentValue(ParamID paramId, float currentValue);
+    
+    // Overrides the table's curve for ramps that start after this call (any thread)
+    void setSmoothingCurve(ParamID paramId, SmoothingCurve curve);
+    
+    // A parameter's values over the block given to process(): numSamples
+    // values while it ramps, otherwise the one value it holds throughout
+    struct BlockValues
+    {
+        const float* ramp = nullptr;
+        float value = 0.0f;             // the value at the end of the block
+    
+        bool isRamping() const { return ramp != nullptr; }
+        float operator[](int sample) const { return ramp != nullptr ? ramp[sample] : value; }
+    };
+    
+    // Processing (audio thread). Blocks longer than prepared still advance
+    // every ramp sample by sample, but hand over its end value as a constant
     void process(int numSamples);
-    float getCurrentValue(const juce::String& paramId) const;
-    bool isSmoothing(const juce::String& paramId) const;
-    bool isAnyParameterSmoothing() const;
+    BlockValues getBlockValues(ParamID paramId) const
+    {
+        const auto index = static_cast<size_t>(paramId);
+        if ((rampedMask & bit(paramId)) != 0)
+            return { rampStorage.data() + index * static_cast<size_t>(maxBlockSize), current[index] };
+    
+        return { nullptr, current[index] };
+    }
+    
+    float getCurrentValue(ParamID paramId) const { return current[static_cast<size_t>(paramId)]; }
+    bool isSmoothing(ParamID paramId) const { return (activeMask & bit(paramId)) != 0; }
+    bool isAnyParameterSmoothing() const { return activeMask != 0; }
     
-    // Bulk operations for preset changes
+    // Bulk operations for preset changes: every parameter ramps to its new
+    // value over the transition time
     void beginPresetTransition(float rampTimeSeconds = 0.1f);
-    void setAllTargetValues(const std::map<juce::String, float>& targetValues);
+    void setAllTargetValues(const ParameterValues& targetValues);
     void endPresetTransition();
     
 private:
-    struct SmoothedParameter
-    {
-        juce::SmoothedValue<float> smoother;
-        float targetValue = 0.0f;
-        bool isActive = false;
-        
-        SmoothedParameter()
-        {
-            smoother.reset(44100.0, 0.05); // Default: 44.1kHz, 50ms ramp
-        }
-    };
+    static_assert(numParamIDs <= 32, "The pending and active masks hold one bit per parameter");
+    
+    static juce::uint32 bit(ParamID paramId) { return 1u << static_cast<juce::uint32>(paramId); }
+    
+    // A one-pole ramp stops this many time constants in, 0.1% short of its
+    // target, and lands on it
+    static constexpr double onePoleTimeConstants = 6.9;
+    
+    // Audio thread state, one lane per parameter. The recurrence runs in
+    // double: the S-curve's cosine recurrence loses accuracy in float over
+    // long ramps. Every lane advances together, so the arrays are aligned
+    // for the vector loop
+    ParameterValues current {};
+    ParameterValues target {};
+    std::array<int, numParamIDs> remaining {};     // samples left in the ramp
+    alignas(32) std::array<double, numParamIDs> state {};
+    alignas(32) std::array<double, numParamIDs> previousState {};
+    alignas(32) std::array<double, numParamIDs> stateMultiplier {};
+    alignas(32) std::array<double, numParamIDs> previousMultiplier {};
+    alignas(32) std::array<double, numParamIDs> stateOffset {};
+    alignas(32) std::array<double, numParamIDs> origin {};
+    juce::uint32 activeMask = 0;
+    
+    // One row of maxBlockSize per parameter, filled for the lanes in
+    // rampedMask, i.e. those that were moving during the last block
+    std::vector<float> rampStorage;
+    int maxBlockSize = 0;
+    juce::uint32 rampedMask = 0;
+    
+    // Posted targets and ramp times, valid for each bit set in pendingMask
+    std::array<std::atomic<float>, numParamIDs> pendingTarget {};
+    std::array<std::atomic<float>, numParamIDs> pendingRampSeconds {};
+    std::atomic<juce::uint32> pendingMask{0};
+    std::array<std::atomic<int>, numParamIDs> curves {};
     
-    std::map<juce::String, SmoothedParameter> parameters;
     double currentSampleRate = 44100.0;
+    float transitionRampSeconds = 0.1f;
     bool isPresetTransition = false;
     
+    void applyPendingTargets();
+    void startRamp(size_t lane, float newTarget, int rampSamples);
+    void advanceRamps(int numSamples);
+    void holdLane(size_t lane);
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSmoother)
 };
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Preallocated float storage shared by the stages of a processing chain
+ * Stages carve their delay lines and per-block scratch out of it while
+ * preparing; nothing is allocated or freed on the audio thread. Storage
+ * comes in large chunks that never move, so pointers stay valid until reset()
+ */
+class ScratchArena
+{
+public:
+    explicit ScratchArena(size_t floatsPerChunk = 16384) : chunkSize(floatsPerChunk) {}
+    
+    // Message thread, while preparing: zeroed storage aligned to a cache line
+    float* allocate(size_t numFloats)
+    {
+        numFloats = (numFloats + alignmentFloats - 1) & ~(alignmentFloats - 1);
+        
+        if (chunks.empty() || chunks.back().used + numFloats > chunks.back().size)
+        {
+            Chunk chunk;
+            chunk.size = juce::jmax(chunkSize, numFloats);
+            chunk.storage.reset(new float[chunk.size + alignmentFloats]());
+            
+            // Start the chunk on a cache line boundary
+            const auto address = reinterpret_cast<std::uintptr_t>(chunk.storage.get());
+            const auto misalignment = (address / sizeof(float)) & (alignmentFloats - 1);
+            chunk.base = chunk.storage.get() + ((alignmentFloats - misalignment) & (alignmentFloats - 1));
+            
+            chunks.push_back(std::move(chunk));
+        }
+        
+        auto& chunk = chunks.back();
+        float* result = chunk.base + chunk.used;
+        chunk.used += numFloats;
+        totalFloats += numFloats;
+        return result;
+    }
+    
+    // Releases everything; every pointer handed out becomes invalid
+    void reset()
+    {
+        chunks.clear();
+        totalFloats = 0;
+    }
+    
+    size_t getBytesAllocated() const { return totalFloats * sizeof(float); }
+    
+private:
+    static constexpr size_t alignmentFloats = 16;   // 64 bytes
+    
+    struct Chunk
+    {
+        std::unique_ptr<float[]> storage;
+        float* base = nullptr;
+        size_t size = 0;
+        size_t used = 0;
+    };
+    
+    size_t chunkSize;
+    std::vector<Chunk> chunks;
+    size_t totalFloats = 0;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchArena)
+};
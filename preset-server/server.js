@@ -70,14 +70,15 @@ RULES:
 - All parameter values must be within valid ranges
 
 BLOCK TYPES & PARAMETERS:
-noise_gate: threshold_db (-90 to 0), release_ms (5 to 500)
+noise_gate: threshold_db (-90 to 0), release_ms (5 to 500), optional mode ("gate"|"duck"|"rhythmic"); rhythmic gates take pattern (16 or 32 characters, "x" open and "." closed, e.g. "x.x.x.x.x.x.x.x."), smoothing (0 to 0.5) and depth (0 to 1)
 compressor: ratio (1 to 10), threshold_db (-60 to 0), attack_ms (0.1 to 50), release_ms (10 to 500), makeup_db (-12 to 12)
 drive: type ("softclip"|"hardclip"|"tubescreamer"|"fuzz"), drive (0 to 1), tone (0 to 1), oversample (1|2|4)
 amp: model ("clean_blackface"|"jangly_vox"|"brit_crunch"|"hi_gain"), gain (0 to 1), bass (0 to 1), mid (0 to 1), treble (0 to 1), presence (0 to 1), master (0 to 1)
 cab: ir_name ("1x12_open"|"2x12_open"|"4x12_closed"), lo_cut_hz (20 to 200), hi_cut_hz (3000 to 12000)
-chorus: rate_hz (0.05 to 5), depth (0 to 1), mix (0 to 1)
-delay: time_ms (40 to 1200), feedback (0 to 0.95), mix (0 to 1)
-reverb: algo ("room"|"plate"|"hall"|"shimmer"), pre_delay_ms (0 to 60), decay_s (0.2 to 12), damping (0 to 1), mix (0 to 1)
+chorus: rate_hz (0.05 to 5), depth (0 to 1), mix (0 to 1), optional voices (1, or 3 to 8 for a 12-string/ensemble thickness)
+delay: time_ms (40 to 1200), feedback (0 to 0.95), mix (0 to 1), optional tempo_sync (true/false) with division ("1/4"|"1/8"|"1/8d"|"1/8t"|"1/16" ...)
+reverb: algo ("room"|"plate"|"hall"|"shimmer"|"convolution"), pre_delay_ms (0 to 60), decay_s (0.2 to 12), damping (0 to 1), mix (0 to 1)
+multiband: bands (2 to 4), crossover_hz (array of bands - 1 ascending values, 40 to 16000), band_params (array per band: threshold_db (-60 to 0), ratio (1 to 10), attack_ms (0.1 to 50), release_ms (10 to 500), makeup_db (-12 to 12), gate_threshold_db (-90 to -20)). Use it to tighten the low end without squashing the highs
 eq: low_shelf_hz (60 to 200), low_gain_db (-12 to 12), mid_hz (300 to 3000), mid_q (0.3 to 4), mid_gain_db (-12 to 12), high_shelf_hz (4000 to 10000), high_gain_db (-12 to 12)
 
 TRADITIONAL TONE EXAMPLES:
@@ -79,7 +79,7 @@ async function testPresetGeneration(description) {
         }
         
         // Check for valid block types
-        const validBlocks = ['noise_gate', 'compressor', 'drive', 'amp', 'cab', 'chorus', 'delay', 'reverb', 'eq'];
+        const validBlocks = ['noise_gate', 'compressor', 'drive', 'amp', 'cab', 'chorus', 'delay', 'reverb', 'eq', 'multiband'];
         const invalidBlocks = preset.chain.filter(block => !validBlocks.includes(block.block));
         
         if (invalidBlocks.length > 0) {